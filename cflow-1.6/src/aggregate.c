@@ -0,0 +1,211 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Aggregated call graph.
+
+   Functions are grouped by the source files they are defined in, or by
+   the directories of these files, and the call graph is collapsed into
+   a graph between the groups.  The weight of an edge between two groups
+   is the number of call edges between their functions.  Calls of
+   functions whose definitions are not seen are ignored. */
+
+int aggregate_mode;                /* AGGREGATE_FILE or AGGREGATE_DIR */
+int aggregate_depth;               /* Number of leading directory
+				      components to keep, 0 for all */
+
+/* Return the name of the group of the function defined in SOURCE */
+static char *
+group_name(const char *source)
+{
+     const char *p, *end;
+     char *name;
+     int n;
+
+     while (strncmp(source, "./", 2) == 0)
+	  source += 2;
+     if (aggregate_mode == AGGREGATE_FILE)
+	  return xstrdup(source);
+
+     end = strrchr(source, '/');
+     if (!end)
+	  return xstrdup(".");
+     if (end == source)
+	  end++;
+     if (aggregate_depth) {
+	  for (p = source + (*source == '/'), n = 0; p < end; p++)
+	       if (*p == '/' && ++n == aggregate_depth) {
+		    end = p;
+		    break;
+	       }
+     }
+     name = xmalloc(end - source + 1);
+     memcpy(name, source, end - source);
+     name[end - source] = 0;
+     return name;
+}
+
+static char **names;               /* Group names of the functions */
+
+static int
+compare_names(const void *a, const void *b)
+{
+     size_t x = *(size_t const *)a;
+     size_t y = *(size_t const *)b;
+     return strcmp(names[x], names[y]);
+}
+
+struct group_edge {
+     size_t from;                  /* Caller group */
+     size_t to;                    /* Callee group */
+};
+
+static int
+compare_edges(const void *a, const void *b)
+{
+     struct group_edge const *x = a;
+     struct group_edge const *y = b;
+
+     if (x->from != y->from)
+	  return x->from < y->from ? -1 : 1;
+     if (x->to != y->to)
+	  return x->to < y->to ? -1 : 1;
+     return 0;
+}
+
+static int
+is_member(Symbol *sym)
+{
+     return sym->source && include_symbol(sym);
+}
+
+/* Build the aggregated graph AG.  Each group is represented by a
+   symbol named after it, so that it can be printed by the output
+   drivers, and the callee list of that symbol holds the groups it
+   calls.  Groups are numbered in lexicographical order of their names,
+   and the edges of each group are sorted by their targets. */
+void
+aggregate_graph(struct aggregate_graph *ag)
+{
+     size_t nfunc = call_graph.nfunctions;
+     size_t *order, *group, ngroups = 0;
+     struct group_edge *edges;
+     size_t nedges = 0, i, j, k, num;
+
+     names = xcalloc(nfunc + 1, sizeof(names[0]));
+     order = xcalloc(nfunc + 1, sizeof(order[0]));
+     for (i = num = 0; i < nfunc; i++)
+	  if (is_member(call_graph.sym[i])) {
+	       names[i] = group_name(call_graph.sym[i]->source);
+	       order[num++] = i;
+	  }
+
+     /* Number the groups in lexicographical order of their names */
+     qsort(order, num, sizeof(order[0]), compare_names);
+     group = xcalloc(nfunc + 1, sizeof(group[0]));
+     for (i = 0; i < num; i++) {
+	  if (i > 0 && strcmp(names[order[i]], names[order[i-1]]))
+	       ngroups++;
+	  group[order[i]] = ngroups;
+     }
+     if (num)
+	  ngroups++;
+
+     /* Collapse the call edges */
+     edges = xcalloc(call_graph.callee.off[nfunc] + 1, sizeof(edges[0]));
+     for (i = 0; i < nfunc; i++) {
+	  if (!names[i])
+	       continue;
+	  for (j = call_graph.callee.off[i]; j < call_graph.callee.off[i+1];
+	       j++) {
+	       size_t n = call_graph.callee.tab[j];
+	       if (n < nfunc && names[n]) {
+		    edges[nedges].from = group[i];
+		    edges[nedges].to = group[n];
+		    nedges++;
+	       }
+	  }
+     }
+     qsort(edges, nedges, sizeof(edges[0]), compare_edges);
+
+     ag->ngroups = ngroups;
+     ag->group = xcalloc(ngroups + 1, sizeof(ag->group[0]));
+     for (i = 0; i < num; i++) {
+	  Symbol *sym = &ag->group[group[order[i]]];
+	  if (!sym->name) {
+	       sym->name = names[order[i]];
+	       sym->arity = -1;
+	       names[order[i]] = NULL;
+	  }
+     }
+
+     /* Merge the parallel edges */
+     ag->edge.off = xcalloc(ngroups + 1, sizeof(ag->edge.off[0]));
+     ag->edge.tab = xcalloc(nedges + 1, sizeof(ag->edge.tab[0]));
+     ag->weight = xcalloc(nedges + 1, sizeof(ag->weight[0]));
+     for (i = k = 0; i < nedges; i = j, k++) {
+	  for (j = i + 1;
+	       j < nedges && compare_edges(&edges[i], &edges[j]) == 0; j++)
+	       ;
+	  ag->edge.tab[k] = edges[i].to;
+	  ag->weight[k] = j - i;
+	  ag->edge.off[edges[i].from + 1]++;
+	  linked_list_append(&ag->group[edges[i].from].callee,
+			     &ag->group[edges[i].to]);
+     }
+     for (i = 0; i < ngroups; i++)
+	  ag->edge.off[i+1] += ag->edge.off[i];
+
+     for (i = 0; i < nfunc; i++)
+	  free(names[i]);
+     free(names);
+     free(order);
+     free(group);
+     free(edges);
+}
+
+void
+aggregate_free(struct aggregate_graph *ag)
+{
+     size_t i;
+
+     for (i = 0; i < ag->ngroups; i++) {
+	  free(ag->group[i].name);
+	  linked_list_destroy(&ag->group[i].callee);
+     }
+     free(ag->group);
+     free(ag->edge.off);
+     free(ag->edge.tab);
+     free(ag->weight);
+}
+
+/* Print the edges of the aggregated graph, one per line, in the form
+   FROM TO WEIGHT, sorted by FROM and TO */
+void
+aggregate_edge_output()
+{
+     struct aggregate_graph ag;
+     size_t i, j;
+
+     aggregate_graph(&ag);
+     for (i = 0; i < ag.ngroups; i++)
+	  for (j = ag.edge.off[i]; j < ag.edge.off[i+1]; j++)
+	       fprintf(outfile, "%s %s %lu\n",
+		       ag.group[i].name, ag.group[ag.edge.tab[j]].name,
+		       (unsigned long) ag.weight[j]);
+     aggregate_free(&ag);
+}
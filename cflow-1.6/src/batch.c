@@ -0,0 +1,252 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+#include <ctype.h>
+
+/* Batched preprocessing.
+
+   With --preprocess-batch=N, up to N input files are passed to a single
+   invocation of the preprocessor, which saves the startup cost of a
+   process per file.  The command must be able to preprocess several
+   files at once, each as a separate translation unit, as e.g. "gcc -E"
+   does.  Its output is split back into the translation units on the
+   line markers that start each of them, i.e. markers without flags
+   naming one of the files that follow in the batch:
+
+     # 1 "next.c"
+
+   The text of each unit is stored in a temporary file and parsed as if
+   it came from its own preprocessor, so that the statics are deleted
+   at each unit boundary and the output is the same as without this
+   option.  Any output preceding the first marker belongs to the first
+   file of the batch.  A file whose marker never shows up (e.g. because
+   the preprocessor failed on it) is parsed as an empty one. */
+
+int pp_batch = 1;                  /* Number of files per preprocessor
+				      invocation */
+
+struct batch_file {
+     char *name;                   /* Input file name */
+     int soft;                     /* Failure to read it is an error */
+     int error;                    /* errno, if the file cannot be opened */
+     FILE *fp;                     /* Its preprocessed text, or NULL */
+};
+
+static struct obstack line_stk;    /* Line of the preprocessor output */
+static struct obstack name_stk;    /* File name from a line marker */
+
+/* Read the next line from FP into line_stk.  Return its length, or 0
+   at end of file. */
+static size_t
+read_line(FILE *fp)
+{
+     int c;
+     size_t len;
+
+     while ((c = getc(fp)) != EOF) {
+	  obstack_1grow(&line_stk, c);
+	  if (c == '\n')
+	       break;
+     }
+     len = obstack_object_size(&line_stk);
+     obstack_1grow(&line_stk, 0);
+     return len;
+}
+
+/* If LINE is a line marker starting one of the COUNT files at FILES,
+   return the index of that file.  Otherwise, return -1. */
+static int
+unit_start(const char *line, struct batch_file *files, int count)
+{
+     const char *p = line;
+     char *name;
+     int i;
+
+     if (*p++ != '#')
+	  return -1;
+     while (*p == ' ' || *p == '\t')
+	  p++;
+     if (!isdigit(*p))
+	  return -1;
+     while (isdigit(*p))
+	  p++;
+     while (*p == ' ' || *p == '\t')
+	  p++;
+     if (*p++ != '"')
+	  return -1;
+     for (; *p != '"'; p++) {
+	  if (*p == '\\' && p[1])
+	       p++;
+	  if (*p == 0 || *p == '\n') {
+	       obstack_free(&name_stk, obstack_finish(&name_stk));
+	       return -1;
+	  }
+	  obstack_1grow(&name_stk, *p);
+     }
+     obstack_1grow(&name_stk, 0);
+     name = obstack_finish(&name_stk);
+     for (p++; *p == ' ' || *p == '\t' || *p == '\r'; p++)
+	  ;
+     if (*p == 0 || *p == '\n') {
+	  for (i = 0; i < count; i++)
+	       if (!files[i].error && strcmp(files[i].name, name) == 0) {
+		    obstack_free(&name_stk, name);
+		    return i;
+	       }
+     }
+     obstack_free(&name_stk, name);
+     return -1;
+}
+
+static FILE *
+temp_file()
+{
+     FILE *fp = tmpfile();
+     if (!fp)
+	  error(EX_FATAL, errno, _("cannot create temporary file"));
+     return fp;
+}
+
+/* Parse the preprocessed text of FILE, or report why FILE could not be
+   read.  Return 1 in the latter case if the failure is an error. */
+static int
+parse_unit(struct batch_file *file)
+{
+     if (file->error) {
+	  error(0, file->error, _("cannot open `%s'"), file->name);
+	  return file->soft;
+     }
+     if (file->fp)
+	  rewind(file->fp);
+     else
+	  file->fp = temp_file();
+     source_file(file->name, file->fp);
+     file->fp = NULL;
+     yyparse();
+     return 0;
+}
+
+/* Preprocess the COUNT files at FILES by a single command and parse
+   them.  Return 1 if some of them could not be read. */
+static int
+parse_batch(struct batch_file *files, int count)
+{
+     struct obstack stk;
+     char *command;
+     FILE *pp;
+     int i, k, cur = -1, next = 0;
+     int status = 0;
+
+     obstack_init(&stk);
+     for (i = 0; i < count; i++) {
+	  if (files[i].error)
+	       continue;
+	  if (obstack_object_size(&stk))
+	       obstack_1grow(&stk, ' ');
+	  obstack_grow(&stk, files[i].name, strlen(files[i].name));
+     }
+     if (obstack_object_size(&stk) == 0) {
+	  for (i = 0; i < count; i++)
+	       status |= parse_unit(&files[i]);
+	  obstack_free(&stk, NULL);
+	  return status;
+     }
+     obstack_1grow(&stk, 0);
+     command = pp_command(obstack_finish(&stk));
+     obstack_free(&stk, NULL);
+
+     pp = popen(command, "r");
+     if (!pp)
+	  error(EX_FATAL, errno, _("cannot execute `%s'"), command);
+     free(command);
+
+     obstack_init(&line_stk);
+     obstack_init(&name_stk);
+     while (read_line(pp)) {
+	  char *line = obstack_finish(&line_stk);
+
+	  k = unit_start(line, files + cur + 1, count - cur - 1);
+	  if (k >= 0 || cur == -1) {
+	       /* Parse the finished unit and the files whose output
+		  is missing */
+	       k = k >= 0 ? cur + 1 + k : 0;
+	       for (; next < k; next++)
+		    status |= parse_unit(&files[next]);
+	       while (files[k].error)
+		    k++;
+	       cur = k;
+	       files[cur].fp = temp_file();
+	  }
+	  fputs(line, files[cur].fp);
+	  obstack_free(&line_stk, line);
+     }
+     pclose(pp);
+     obstack_free(&line_stk, NULL);
+     obstack_free(&name_stk, NULL);
+
+     for (; next < count; next++)
+	  status |= parse_unit(&files[next]);
+     return status;
+}
+
+/* Parse the input files from LIST and ARGV, preprocessing them in
+   batches of pp_batch files.  Failure to read a file from ARGV is
+   reported by the return value. */
+int
+parse_batched(struct linked_list *list, int argc, char **argv)
+{
+     struct batch_file *files;
+     struct linked_list_entry *p;
+     size_t count, i, j;
+     int n;
+     int status = EX_OK;
+
+     /* cpp takes its second argument for the name of the output file */
+     n = strcspn(pp_bin, " \t");
+     if (n >= 3 && strncmp(pp_bin + n - 3, "cpp", 3) == 0)
+	  error(EX_USAGE, 0,
+		_("%.*s cannot preprocess several files at once; "
+		  "use e.g. --cpp='gcc -E' with --preprocess-batch"),
+		n, pp_bin);
+
+     count = linked_list_size(list) + argc;
+     files = xcalloc(count + 1, sizeof(files[0]));
+     for (p = linked_list_head(list), i = 0; p; p = p->next, i++)
+	  files[i].name = p->data;
+     for (; i < count; i++) {
+	  files[i].name = *argv++;
+	  files[i].soft = 1;
+     }
+
+     for (i = 0; i < count; i = j) {
+	  /* Files that cannot be opened are not passed to the
+	     preprocessor, nor counted against the batch size */
+	  for (j = i, n = 0; j < count && n < pp_batch; j++) {
+	       FILE *fp = fopen(files[j].name, "r");
+
+	       if (fp) {
+		    fclose(fp);
+		    n++;
+	       } else
+		    files[j].error = errno;
+	  }
+	  if (parse_batch(files + i, j - i))
+	       status = EX_SOFT;
+     }
+     free(files);
+     return status;
+}
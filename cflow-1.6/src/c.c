@@ -2782,6 +2782,17 @@ init_lex(int debug_level)
      init_tokens();
 }
 
+/* Discard the strings of the previous run and reinstall the keywords,
+   after the symbol table has been cleared */
+void
+reset_lex()
+{
+     obstack_free(&string_stk, NULL);
+     obstack_init(&string_stk);
+     init_tokens();
+     prev_token = 0;
+}
+
 int
 ident()
 {
@@ -2799,6 +2810,12 @@ ident()
 	       yylval.str = sp->name;
 	       return sp->token_type;
           }
+	  /* Names of symbols are never freed, so the name of a known
+	     identifier can be used instead of a new copy */
+	  if (sp) {
+	       yylval.str = sp->name;
+	       return IDENTIFIER;
+	  }
      }
      obstack_grow(&string_stk, yytext, yyleng);
      obstack_1grow(&string_stk, 0);
@@ -2846,10 +2863,11 @@ pp_finalize()
      opt_stack = NULL;
 }
 
-FILE *
-pp_open(const char *name)
+/* Return the command line preprocessing the file NAME.  The returned
+   string must be freed by the caller. */
+char *
+pp_command(const char *name)
 {
-     FILE *fp;
      char *s;
      size_t size;
      
@@ -2866,6 +2884,15 @@ pp_open(const char *name)
      strcat(s, name);
      if (debug)
 	  fprintf(stderr, _("Command line: %s\n"), s);
+     return s;
+}
+
+FILE *
+pp_open(const char *name)
+{
+     FILE *fp;
+     char *s = pp_command(name);
+     
      fp = popen(s, "r");
      if (!fp)
 	  error(0, errno, _("cannot execute `%s'"), s);
@@ -2881,14 +2908,40 @@ pp_close(FILE *fp)
 
 
 
+#if HAVE_SYS_MMAN_H
+# include <sys/stat.h>
+# include <sys/mman.h>
+# ifndef MAP_ANONYMOUS
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+#endif
+
+static int memory_input;       /* Input comes from memory */
+static int pipe_input;         /* Input comes from pp_open() */
+static char *map_base;         /* Memory mapped input file, or NULL */
+static size_t map_size;        /* Its size, including the two NULs */
+
 int
 yywrap()
 {
+     if (memory_input) {
+	  memory_input = 0;
+	  yy_delete_buffer(YY_CURRENT_BUFFER);
+#if HAVE_SYS_MMAN_H
+	  if (map_base) {
+	       munmap(map_base, map_size);
+	       map_base = NULL;
+	  }
+#endif
+	  delete_statics();
+	  return 1;
+     }
      if (!yyin)
 	  return 1;
-     if (preprocess_option)
+     if (pipe_input) {
 	  pp_close(yyin);
-     else
+	  pipe_input = 0;
+     } else
 	  fclose(yyin);
      yyin = NULL;
 #ifdef FLEX_SCANNER
@@ -2916,6 +2969,53 @@ get_token()
      return tok;
 }
 
+/* Map the input file open on FD into memory, so that it is scanned in
+   place, without copying it to the scanner buffer.  Flex requires the
+   buffer to end with two NUL bytes, which is why a zero-filled area
+   slightly larger than the file is mapped first.  The mapping is
+   private, since the scanner modifies the buffer.  On success, set
+   map_base and map_size and return 0.  Otherwise, return 1 and let
+   the caller read the file. */
+static int
+map_input(int fd)
+{
+#if HAVE_SYS_MMAN_H
+     struct stat st;
+     size_t size;
+     char *base;
+
+     if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0)
+	  return 1;
+     size = st.st_size + 2;
+     base = mmap(NULL, size, PROT_READ|PROT_WRITE,
+		 MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+     if (base == MAP_FAILED)
+	  return 1;
+     if (mmap(base, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FIXED,
+	      fd, 0) == MAP_FAILED) {
+	  munmap(base, size);
+	  return 1;
+     }
+     map_base = base;
+     map_size = size;
+     return 0;
+#else
+     return 1;
+#endif
+}
+
+/* Prepare for reading tokens from the input file NAME */
+static void
+source_init(char *name)
+{
+     obstack_grow(&string_stk, name, strlen(name)+1);
+     filename = obstack_finish(&string_stk);
+     canonical_filename = filename;
+     line_num = 1;
+     input_file_count++;
+     hit_eof = 0;
+}
+
 int
 source(char *name)
 {
@@ -2931,18 +3031,37 @@ source(char *name)
 	  fp = pp_open(name);
 	  if (!fp)
 	       return 1;
+	  pipe_input = 1;
      }
-     obstack_grow(&string_stk, name, strlen(name)+1);
-     filename = obstack_finish(&string_stk);
-     canonical_filename = filename;
-     line_num = 1;
-     input_file_count++;
-     hit_eof = 0;
-
-     yyrestart(fp);
+     source_file(name, fp);
      return 0;
 }
 
+/* Prepare for reading tokens of the input file NAME from FP, which is
+   closed when all of them are read.  FP is either the file itself, its
+   preprocessed copy, or a pipe from pp_open(). */
+void
+source_file(char *name, FILE *fp)
+{
+     source_init(name);
+     if (!pipe_input && map_input(fileno(fp)) == 0) {
+	  fclose(fp);
+	  yy_scan_buffer(map_base, map_size);
+	  memory_input = 1;
+     } else
+	  yyrestart(fp);
+}
+
+/* Prepare for reading tokens of the input file NAME from the LEN bytes
+   at BUF.  The input is not preprocessed. */
+void
+source_buffer(char *name, const char *buf, size_t len)
+{
+     source_init(name);
+     yy_scan_bytes(buf, len);
+     memory_input = 1;
+}
+
 static int
 getnum(unsigned  base, int  count)
 {
@@ -2999,9 +3118,12 @@ update_loc()
 	  
 	  for (p++, n = 0; p[n] && p[n] != '"'; n++)
 	       ;
-	  obstack_grow(&string_stk, p, n);
-	  obstack_1grow(&string_stk, 0);
-	  filename = obstack_finish(&string_stk);
+	  /* The file name rarely changes between two line markers */
+	  if (strncmp(filename, p, n) || filename[n]) {
+	       obstack_grow(&string_stk, p, n);
+	       obstack_1grow(&string_stk, 0);
+	       filename = obstack_finish(&string_stk);
+	  }
      }
      if (debug > 1)
 	  fprintf(stderr, _("New location: %s:%d\n"), filename, line_num);
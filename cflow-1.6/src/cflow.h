@@ -96,6 +96,7 @@ typedef struct symbol Symbol;
 struct symbol {
      struct table_entry *owner;
      Symbol *next;                 /* Next symbol with the same hash */
+     Symbol *prev_alloc, *next_alloc; /* List of all allocated symbols */
      struct linked_list_entry *entry;
      
      enum symtype type;            /* Type of the symbol */
@@ -114,6 +115,8 @@ struct symbol {
      int token_type;               /* Type of the token */
      char *source;                 /* Source file */
      int def_line;                 /* Source line */
+     int end_line;                 /* Last line of the function body, or
+				      0 if not known */
      struct linked_list *ref_line; /* Referenced in */
      
      int level;                    /* Block nesting level (for local vars),
@@ -125,7 +128,8 @@ struct symbol {
      int arity;                    /* Number of parameters or -1 for
 				      variables */  
      
-     int recursive;                /* Is the function recursive */
+     int recursive;                /* If the function is recursive, number
+				      of the call cycle it is part of */
      size_t ord;                   /* ordinal number */
      struct linked_list *caller;   /* List of callers */
      struct linked_list *callee;   /* List of callees */
@@ -134,6 +138,30 @@ struct symbol {
 /* Output flags */
 #define PRINT_XREF 0x01
 #define PRINT_TREE 0x02
+#define PRINT_REACH 0x04
+#define PRINT_PATH  0x08
+#define PRINT_UNREACHABLE 0x10
+#define PRINT_DEPTH 0x20
+#define PRINT_NEIGHBORHOOD 0x40
+#define PRINT_IMPACT 0x80
+#define PRINT_AGGREGATE 0x100
+#define PRINT_DOMINATORS 0x200
+#define PRINT_REACH_COUNTS 0x400
+#define PRINT_STATS 0x800
+#define PRINT_REACH_MATRIX 0x1000
+/* Output modes that need the frozen call graph */
+#define PRINT_GRAPH \
+  (PRINT_TREE|PRINT_REACH|PRINT_PATH|PRINT_UNREACHABLE|PRINT_DEPTH\
+   |PRINT_NEIGHBORHOOD|PRINT_IMPACT|PRINT_AGGREGATE|PRINT_DOMINATORS\
+   |PRINT_REACH_COUNTS|PRINT_STATS|PRINT_REACH_MATRIX)
+
+/* Symbol classes (see include_symbol) */
+#define SM_FUNCTIONS   0x0001
+#define SM_DATA        0x0002
+#define SM_STATIC      0x0004
+#define SM_UNDERSCORE  0x0008
+#define SM_TYPEDEF     0x0010
+#define SM_UNDEFINED   0x0020
 
 #ifndef CFLOW_PREPROC
 # define CFLOW_PREPROC "/usr/bin/cpp"
@@ -147,6 +175,7 @@ extern char *outname;
 
 extern int verbose;
 extern int print_option;
+extern int symbol_map;
 extern int use_indentation;
 extern int assume_cplusplus;
 extern int record_defines;
@@ -161,13 +190,29 @@ extern int brief_listing;
 extern int reverse_tree;
 extern int out_line;
 extern char *start_name;
+extern struct linked_list *start_list;
 extern int all_functions;
+extern int threads;
 extern int max_depth;
 extern int emacs_option;
 extern int debug;
 extern int preprocess_option;
 extern int omit_arguments_option;
 extern int omit_symbol_names_option;
+extern int print_cycles_option;
+extern int compress_tree;
+extern int first_line;
+extern int last_line;
+extern size_t max_output_lines;
+extern size_t max_output_bytes;
+extern struct linked_list *reach_pairs;
+extern struct linked_list *reach_files;
+extern struct linked_list *impact_files;
+extern struct linked_list *path_pairs;
+extern size_t path_count;
+extern struct linked_list *neighborhood_names;
+extern int neighborhood_radius;
+extern int edge_list;
 
 extern int token_stack_length;
 extern int token_stack_increase;
@@ -186,10 +231,12 @@ Symbol *install_ident(char *name, enum storage storage);
 void ident_change_storage(Symbol *sp, enum storage storage);
 void delete_autos(int level);
 void delete_statics(void);
+void delete_all_symbols(void);
 void delete_parms(int level);
 void move_parms(int level);
 size_t collect_symbols(Symbol ***, int (*sel)(), size_t rescnt);
 size_t collect_functions(Symbol ***return_sym);
+void add_edge(Symbol *caller, Symbol *callee);
 struct linked_list *linked_list_create(linked_list_free_data_fp fun);
 void linked_list_destroy(struct linked_list **plist);
 void linked_list_append(struct linked_list **plist, void *data);
@@ -200,25 +247,37 @@ void linked_list_unlink(struct linked_list *list,
 			struct linked_list_entry *ent);
 size_t linked_list_size(struct linked_list *list);
 
-int data_in_list(void *data, struct linked_list *list);
-
 int get_token(void);
 int source(char *name);
+void source_buffer(char *name, const char *buf, size_t len);
+void source_file(char *name, FILE *fp);
 void init_lex(int debug_level);
+void reset_lex(void);
 void set_preprocessor(const char *arg);
 void pp_option(const char *arg); 
+char *pp_command(const char *name);
+extern char *pp_bin;
 
 void init_parse(void);
+void reset_parse(void);
 int yyparse(void);
 
+void init(void);
 void output(void);
+void output_stream(FILE *fp);
+extern int output_status;
+void no_such_function(const char *name);
 void newline(void);
 void print_level(int lev, int last);
 int globals_only(void);
 int include_symbol(Symbol *sym);
+unsigned thread_count(void);
 int symbol_is_function(Symbol *sym);
 
 void sourcerc(int *, char ***);
+typedef void (*word_file_fp) (const char *file, int line,
+			      int wordc, char **wordv, void *data);
+void read_word_file(const char *name, word_file_fp fun, void *data);
 
 typedef enum {
      cflow_output_init,
@@ -235,6 +294,12 @@ struct output_symbol {
      int level;
      int last;
      Symbol *sym;
+     size_t id;                    /* Node ID in compressed output, or 0 */
+     int ref;                      /* Refer to the subtree printed
+				      before under this ID */
+     int leaf;                     /* Nothing is printed below it */
+     size_t weight;                /* Weight of the edge leading to it,
+				      or 0 */
 };
 
 int register_output(const char *name,
@@ -253,8 +318,108 @@ int posix_output_handler(cflow_output_command cmd,
 			 void *data, void *handler_data);
 
 
+/* Parallel preprocessing (see jobs.c) */
+extern int jobs;
+int parse_parallel(struct linked_list *list, int argc, char **argv);
+
+/* Batched preprocessing (see batch.c) */
+extern int pp_batch;
+int parse_batched(struct linked_list *list, int argc, char **argv);
+
+
+/* Frozen call graph (see graph.c) */
+struct graph_adjacency {
+     size_t *off;                  /* Offsets into tab, indexed by ord */
+     size_t *tab;                  /* Ordinal numbers of adjacent nodes */
+};
+
+struct cflow_graph {
+     size_t nodes;                 /* Number of nodes */
+     size_t nfunctions;            /* Nodes 0..nfunctions-1 are functions */
+     Symbol **sym;                 /* Node symbols, indexed by ord */
+     size_t *by_name;              /* Nodes sorted by name (see
+				      graph_find) */
+     struct graph_adjacency callee;
+     struct graph_adjacency caller;
+     size_t nscc;                  /* Number of strongly connected
+				      components */
+     size_t *scc;                  /* Component of each node */
+     size_t *scc_size;             /* Number of nodes in each component */
+     struct graph_adjacency scc_nodes;  /* Nodes of each component */
+     struct graph_adjacency scc_callee; /* Condensation DAG (see */
+     struct graph_adjacency scc_caller; /* graph_condense) */
+};
+
+#define GRAPH_NONE ((size_t)-1)
+
+extern struct cflow_graph call_graph;
+
+void graph_freeze(void);
+void graph_free(void);
+size_t graph_node(Symbol *sym);
+size_t graph_adjacent(struct graph_adjacency *adj, Symbol *sym,
+		      size_t **ptab);
+void graph_scc(void);
+int graph_node_recursive(size_t n);
+void graph_mark_recursive(size_t *nodes, size_t count);
+size_t graph_find(const char *name, size_t **return_nodes);
+size_t graph_reachable(struct graph_adjacency *adj, Symbol *root, int depth,
+		       int (*sel)(Symbol *), size_t **return_nodes);
+void graph_condense(void);
+
+/* Dominators (see dom.c) */
+size_t graph_dominators(size_t root, int (*sel)(Symbol *),
+			size_t **return_idom);
+
+/* Reachability queries (see reach.c) */
+void reach_index_build(void);
+void reach_index_free(void);
+int reach_query(size_t from, size_t to);
+void reach_output(void);
+void reach_matrix_output(void);
+void unreachable_output(void);
+void impact_output(void);
+
+/* Aggregated graph (see aggregate.c) */
+#define AGGREGATE_FILE 1
+#define AGGREGATE_DIR  2
+
+extern int aggregate_mode;
+extern int aggregate_depth;
+
+struct aggregate_graph {
+     Symbol *group;                /* Groups, sorted by name */
+     size_t ngroups;               /* Number of groups */
+     struct graph_adjacency edge;  /* Edges, indexed by group number */
+     size_t *weight;               /* Number of calls along each edge */
+};
+
+void aggregate_graph(struct aggregate_graph *ag);
+void aggregate_free(struct aggregate_graph *ag);
+void aggregate_edge_output(void);
+
+/* Transitive reach counts (see sketch.c) */
+void reach_counts_output(void);
+
+/* Call graph statistics (see stats.c) */
+void stats_output(void);
+
+/* Call depth report (see depth.c) */
+extern struct linked_list *stack_usage_files;
+void depth_output(void);
+
+/* Shortest paths (see path.c) */
+struct call_path {
+     size_t len;                   /* Number of nodes */
+     size_t *nodes;                /* Nodes, from the caller down */
+};
+
+size_t path_shortest(size_t from, size_t to, int (*sel)(Symbol *), size_t k,
+		     struct call_path **return_paths);
+void path_free(struct call_path *paths, size_t n);
+
 typedef struct cflow_depmap *cflow_depmap_t;
 cflow_depmap_t depmap_alloc(size_t count);
 void depmap_set(cflow_depmap_t dmap, size_t row, size_t col);
 int depmap_isset(cflow_depmap_t dmap, size_t row, size_t col);
-void depmap_tc(cflow_depmap_t dmap);
+void depmap_tc(cflow_depmap_t dmap, unsigned nthreads);
@@ -0,0 +1,191 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Test driver for libcflow.
+
+   Usage: cflowapi [-bx] [-f DRIVER] [-m START] [-r FLAGS] [-t N] FILE...
+
+   Parses FILEs in a library context and lists its symbols and edges.
+   Options:
+
+     -b         pass the files to the library as buffers
+     -f DRIVER  render the graph with DRIVER instead of listing it
+     -m START   start function for rendering
+     -r FLAGS   render flags: any of "xrbna" (xref, reverse, brief,
+                number, all)
+     -t N       process the files in N contexts, each in its own thread,
+                and check that the results are the same */
+
+#include <cflow.h>
+#include <libcflow.h>
+#include <pthread.h>
+
+static int buffers;
+static char *driver;
+static char *start;
+static int flags;
+static char **files;
+static int nfiles;
+
+struct job {
+     pthread_t tid;
+     cflow_ctx *ctx;
+     int status;
+     char *text;                   /* Symbol listing or rendered graph */
+     size_t size;
+     int render_status;            /* Return value of cflow_render */
+};
+
+static void
+list_symbols(cflow_ctx *ctx, FILE *fp)
+{
+     size_t i, j, n;
+     const size_t *tab;
+
+     for (i = 0; i < cflow_symbol_count(ctx); i++) {
+	  const struct cflow_symbol *sym = cflow_symbol(ctx, i);
+
+	  fprintf(fp, "%s", sym->name);
+	  if (sym->source)
+	       fprintf(fp, " %s:%d", sym->source, sym->line);
+	  if (sym->flags & CFLOW_SYMBOL_FUNCTION)
+	       fprintf(fp, " function");
+	  if (sym->flags & CFLOW_SYMBOL_STATIC)
+	       fprintf(fp, " static");
+	  if (sym->flags & CFLOW_SYMBOL_RECURSIVE)
+	       fprintf(fp, " recursive");
+	  fprintf(fp, "\n");
+	  n = cflow_callees(ctx, i, &tab);
+	  for (j = 0; j < n; j++)
+	       fprintf(fp, "  -> %s\n", cflow_symbol(ctx, tab[j])->name);
+     }
+}
+
+static void
+add_sources(cflow_ctx *ctx)
+{
+     int i;
+
+     for (i = 0; i < nfiles; i++) {
+	  if (buffers) {
+	       FILE *fp = fopen(files[i], "r");
+	       char buf[4096];
+	       size_t n;
+	       struct obstack stk;
+
+	       if (!fp)
+		    error(EX_FATAL, errno, "cannot open `%s'", files[i]);
+	       obstack_init(&stk);
+	       while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+		    obstack_grow(&stk, buf, n);
+	       fclose(fp);
+	       n = obstack_object_size(&stk);
+	       cflow_add_buffer(ctx, files[i], obstack_finish(&stk), n);
+	       obstack_free(&stk, NULL);
+	  } else
+	       cflow_add_file(ctx, files[i]);
+     }
+}
+
+static void *
+thread_main(void *data)
+{
+     struct job *job = data;
+     FILE *fp;
+
+     job->ctx = cflow_ctx_create();
+     if (!job->ctx)
+	  error(EX_FATAL, errno, "cannot create context");
+     add_sources(job->ctx);
+     job->status = cflow_finish(job->ctx);
+     if (job->status == -1)
+	  error(EX_FATAL, errno, "cannot parse");
+     fp = open_memstream(&job->text, &job->size);
+     if (driver)
+	  job->render_status = cflow_render(job->ctx, driver, start, flags,
+					    fp);
+     else
+	  list_symbols(job->ctx, fp);
+     fclose(fp);
+     return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+     int c, i, nthreads = 1, status;
+     struct job *job;
+
+     while ((c = getopt(argc, argv, "bf:m:r:t:")) != EOF) {
+	  switch (c) {
+	  case 'b':
+	       buffers = 1;
+	       break;
+	  case 'f':
+	       driver = optarg;
+	       break;
+	  case 'm':
+	       start = optarg;
+	       break;
+	  case 'r':
+	       for (; *optarg; optarg++)
+		    switch (*optarg) {
+		    case 'x': flags |= CFLOW_RENDER_XREF; break;
+		    case 'r': flags |= CFLOW_RENDER_REVERSE; break;
+		    case 'b': flags |= CFLOW_RENDER_BRIEF; break;
+		    case 'n': flags |= CFLOW_RENDER_NUMBER; break;
+		    case 'a': flags |= CFLOW_RENDER_ALL; break;
+		    default:
+			 error(EX_USAGE, 0, "unknown render flag %c", *optarg);
+		    }
+	       break;
+	  case 't':
+	       nthreads = atoi(optarg);
+	       if (nthreads < 1)
+		    error(EX_USAGE, 0, "invalid number of threads");
+	       break;
+	  default:
+	       exit(EX_USAGE);
+	  }
+     }
+     files = argv + optind;
+     nfiles = argc - optind;
+
+     job = xcalloc(nthreads, sizeof(job[0]));
+     for (i = 0; i < nthreads; i++)
+	  if (pthread_create(&job[i].tid, NULL, thread_main, &job[i]))
+	       error(EX_FATAL, errno, "cannot create thread");
+     for (i = 0; i < nthreads; i++)
+	  pthread_join(job[i].tid, NULL);
+     for (i = 1; i < nthreads; i++)
+	  if (job[i].status != job[0].status
+	      || job[i].render_status != job[0].render_status
+	      || job[i].size != job[0].size
+	      || memcmp(job[i].text, job[0].text, job[0].size))
+	       error(EX_FATAL, 0, "results of threads 0 and %d differ", i);
+
+     if (job[0].render_status)
+	  error(EX_USAGE, 0, "cannot render with driver %s", driver);
+     status = job[0].status ? EX_SOFT : EX_OK;
+     fwrite(job[0].text, job[0].size, 1, stdout);
+
+     for (i = 0; i < nthreads; i++) {
+	  cflow_ctx_free(job[i].ctx);
+	  free(job[i].text);
+     }
+     free(job);
+     return status;
+}
@@ -0,0 +1,211 @@
+/* This file is part of GNU cflow.
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GNU cflow.  If not, see <http://www.gnu.org/licenses/>. */
+
+/* Microbenchmark for the transitive closure kernel.
+
+   Usage: depmap-bench [-d DEGREE] [-r MAXREF] [-s SEED] [-t THREADS] [N...]
+
+   For each N (default: 1000 10000 50000) a random graph with N nodes
+   and DEGREE (default 4) edges per node is generated, and its
+   transitive closure is computed using the original row-at-a-time
+   32-bit kernel (only if N <= MAXREF, default 10000), the blocked
+   kernel of depmap.c in one thread, and the same kernel in THREADS
+   threads.  The results are compared and the timings printed. */
+
+#include <cflow.h>
+#include <limits.h>
+#include <time.h>
+
+void
+xalloc_die(void)
+{
+     error(EX_FATAL, ENOMEM, "Exiting");
+     abort();
+}
+
+/* The original kernel */
+
+#define REF_BITS_PER_WORD   (sizeof(unsigned)*CHAR_BIT)
+#define REF_WORDSIZE(n)     (((n) + REF_BITS_PER_WORD - 1) / REF_BITS_PER_WORD)
+#define REF_SETBIT(x, i) \
+     ((x)[(i)/REF_BITS_PER_WORD] |= (1U<<((i) % REF_BITS_PER_WORD)))
+#define REF_BITISSET(x, i) \
+     (((x)[(i)/REF_BITS_PER_WORD] & (1U<<((i) % REF_BITS_PER_WORD))) != 0)
+
+static void
+transitive_closure(unsigned *R, int n)
+{
+     register size_t rowsize;
+     register unsigned mask;
+     register unsigned *rowj;
+     register unsigned *rp;
+     register unsigned *rend;
+     register unsigned *ccol;
+
+     unsigned *relend;
+     unsigned *cword;
+     unsigned *rowi;
+
+     rowsize = REF_WORDSIZE (n) * sizeof (unsigned);
+     relend = (unsigned *) ((char *) R + (n * rowsize));
+
+     cword = R;
+     mask = 1;
+     rowi = R;
+     while (rowi < relend) {
+	  ccol = cword;
+	  rowj = R;
+
+	  while (rowj < relend) {
+	       if (*ccol & mask) {
+		    rp = rowi;
+		    rend = (unsigned *) ((char *) rowj + rowsize);
+
+		    while (rowj < rend)
+			 *rowj++ |= *rp++;
+	       } else {
+		    rowj = (unsigned *) ((char *) rowj + rowsize);
+	       }
+
+	       ccol = (unsigned *) ((char *) ccol + rowsize);
+	  }
+
+	  mask <<= 1;
+	  if (mask == 0) {
+	       mask = 1;
+	       cword++;
+	  }
+	  rowi = (unsigned *) ((char *) rowi + rowsize);
+     }
+}
+
+static double
+now(void)
+{
+     struct timespec ts;
+     clock_gettime(CLOCK_MONOTONIC, &ts);
+     return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Simple LCG, so that the graphs are reproducible across systems */
+static unsigned long seed = 1;
+
+static size_t
+rnd(size_t n)
+{
+     seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+     return (seed >> 33) % n;
+}
+
+static void
+bench(size_t n, size_t degree, size_t maxref, unsigned nthreads)
+{
+     size_t *edges = xcalloc(n * degree, sizeof(edges[0]));
+     unsigned *ref = NULL;
+     cflow_depmap_t dm1, dmt;
+     size_t i, j, bad = 0;
+     double t, tref = -1, t1, tt;
+
+     for (i = 0; i < n * degree; i++)
+	  edges[i] = rnd(n);
+
+     dm1 = depmap_alloc(n);
+     dmt = depmap_alloc(n);
+     if (n <= maxref)
+	  ref = xcalloc(n * REF_WORDSIZE(n), sizeof(ref[0]));
+     for (i = 0; i < n; i++)
+	  for (j = 0; j < degree; j++) {
+	       size_t k = edges[i * degree + j];
+	       depmap_set(dm1, i, k);
+	       depmap_set(dmt, i, k);
+	       if (ref)
+		    REF_SETBIT(ref + i * REF_WORDSIZE(n), k);
+	  }
+     free(edges);
+
+     if (ref) {
+	  t = now();
+	  transitive_closure(ref, n);
+	  tref = now() - t;
+     }
+
+     t = now();
+     depmap_tc(dm1, 1);
+     t1 = now() - t;
+
+     t = now();
+     depmap_tc(dmt, nthreads);
+     tt = now() - t;
+
+     for (i = 0; i < n; i++)
+	  for (j = 0; j < n; j++) {
+	       int b = depmap_isset(dm1, i, j);
+	       if (b != depmap_isset(dmt, i, j)
+		   || (ref && b != REF_BITISSET(ref + i * REF_WORDSIZE(n), j)))
+		    bad++;
+	  }
+
+     if (tref >= 0)
+	  printf("%8zu %12.3f", n, tref);
+     else
+	  printf("%8zu %12s", n, "-");
+     printf(" %12.3f %12.3f %s\n", t1, tt, bad ? "MISMATCH" : "ok");
+     fflush(stdout);
+     if (bad)
+	  error(EX_FATAL, 0, "%zu mismatches for n=%zu", bad, n);
+
+     free(ref);
+     free(dm1);
+     free(dmt);
+}
+
+int
+main(int argc, char **argv)
+{
+     static size_t defsizes[] = { 1000, 10000, 50000 };
+     size_t degree = 4, maxref = 10000;
+     unsigned nthreads = 4;
+     int c, i;
+
+     while ((c = getopt(argc, argv, "d:r:s:t:")) != EOF) {
+	  switch (c) {
+	  case 'd':
+	       degree = strtoul(optarg, NULL, 10);
+	       break;
+	  case 'r':
+	       maxref = strtoul(optarg, NULL, 10);
+	       break;
+	  case 's':
+	       seed = strtoul(optarg, NULL, 10);
+	       break;
+	  case 't':
+	       nthreads = strtoul(optarg, NULL, 10);
+	       break;
+	  default:
+	       exit(EX_USAGE);
+	  }
+     }
+
+     printf("%8s %12s %12s %12s\n", "N", "original", "blocked",
+	    "threads");
+     if (optind == argc)
+	  for (i = 0; i < NUMITEMS(defsizes); i++)
+	       bench(defsizes[i], degree, maxref, nthreads);
+     else
+	  for (i = optind; i < argc; i++)
+	       bench(strtoul(argv[i], NULL, 10), degree, maxref, nthreads);
+     return 0;
+}
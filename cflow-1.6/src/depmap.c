@@ -15,82 +15,39 @@
    along with GNU cflow.  If not, see <http://www.gnu.org/licenses/>. */
 
 #include <cflow.h>
+#include <stdint.h>
+#include <pthread.h>
 
-#ifndef CHAR_BIT
-# define CHAR_BIT 8
-#endif
-#define BITS_PER_WORD   (sizeof(unsigned)*CHAR_BIT)
+/* The dependency matrix is stored as NROWS rows of ROWLEN 64-bit words.
+   Bit J of row I is set if function I calls function J. */
 
-#define WORDSIZE(n)     (((n) + BITS_PER_WORD - 1) / BITS_PER_WORD)
-#define SETBIT(x, i)    ((x)[(i)/BITS_PER_WORD] |= (1<<((i) % BITS_PER_WORD)))
-#define RESETBIT(x, i)  ((x)[(i)/BITS_PER_WORD] &= ~(1<<((i) % BITS_PER_WORD)))
-#define BITISSET(x, i)  (((x)[(i)/BITS_PER_WORD] & (1<<((i) % BITS_PER_WORD))) != 0)
+typedef uint64_t depmap_word_t;
 
-static void
-transitive_closure(unsigned *R, int n)
-{
-     register size_t rowsize;
-     register unsigned mask;
-     register unsigned *rowj;
-     register unsigned *rp;
-     register unsigned *rend;
-     register unsigned *ccol;
-     
-     unsigned *relend;
-     unsigned *cword;
-     unsigned *rowi;
-     
-     rowsize = WORDSIZE (n) * sizeof (unsigned);
-     relend = (unsigned *) ((char *) R + (n * rowsize));
-     
-     cword = R;
-     mask = 1;
-     rowi = R;
-     while (rowi < relend) {
-	  ccol = cword;
-	  rowj = R;
-                
-	  while (rowj < relend) {
-	       if (*ccol & mask) {
-		    rp = rowi;
-		    rend = (unsigned *) ((char *) rowj + rowsize);
-                                
-		    while (rowj < rend)
-			 *rowj++ |= *rp++;
-	       } else {
-		    rowj = (unsigned *) ((char *) rowj + rowsize);
-	       }
-	  
-	       ccol = (unsigned *) ((char *) ccol + rowsize);
-	  }
-                
-	  mask <<= 1;
-	  if (mask == 0) {
-	       mask = 1;
-	       cword++;
-	  }
-	  rowi = (unsigned *) ((char *) rowi + rowsize);
-     }
-}
+#define BITS_PER_WORD   64
+#define WORDSIZE(n)     (((n) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+#define WORDBIT(i)      ((depmap_word_t)1 << ((i) % BITS_PER_WORD))
+#define SETBIT(x, i)    ((x)[(i)/BITS_PER_WORD] |= WORDBIT(i))
+#define RESETBIT(x, i)  ((x)[(i)/BITS_PER_WORD] &= ~WORDBIT(i))
+#define BITISSET(x, i)  (((x)[(i)/BITS_PER_WORD] & WORDBIT(i)) != 0)
 
 struct cflow_depmap {
      size_t nrows;
      size_t rowlen;
-     unsigned r[1];
+     depmap_word_t r[1];
 };
   
 cflow_depmap_t
 depmap_alloc(size_t count)
 {
-     size_t size = (count + BITS_PER_WORD - 1) / BITS_PER_WORD;
-     cflow_depmap_t dmap = xzalloc(sizeof(*dmap) - 1 
-				   + count * size * sizeof(unsigned));
+     size_t size = WORDSIZE(count);
+     cflow_depmap_t dmap = xzalloc(sizeof(*dmap) - sizeof(dmap->r)
+				   + count * size * sizeof(dmap->r[0]));
      dmap->nrows  = count;
      dmap->rowlen = size;
      return dmap;
 }
 
-static unsigned *
+static depmap_word_t *
 depmap_rowptr(cflow_depmap_t dmap, size_t row)
 {
      return dmap->r + dmap->rowlen * row;
@@ -99,20 +56,260 @@ depmap_rowptr(cflow_depmap_t dmap, size_t row)
 void
 depmap_set(cflow_depmap_t dmap, size_t row, size_t col)
 {
-     unsigned *rptr = depmap_rowptr(dmap, row);
+     depmap_word_t *rptr = depmap_rowptr(dmap, row);
      SETBIT(rptr, col);
 }
 
 int
 depmap_isset(cflow_depmap_t dmap, size_t row, size_t col)
 {
-     unsigned *rptr = depmap_rowptr(dmap, row);
+     depmap_word_t *rptr = depmap_rowptr(dmap, row);
      return BITISSET(rptr, col);
 }
 
-void
-depmap_tc(cflow_depmap_t dmap)
+/* Transitive closure.
+
+   This is Warshall's algorithm, processed in blocks of BITS_PER_WORD
+   pivots, i.e. one column word at a time.  For each block K:
+
+   1. The pivot rows (rows whose numbers fall into K) are updated
+      using the plain algorithm, restricted to the pivots in K.
+
+   2. Each of the remaining rows I is updated at once: the pivots to
+      apply are determined by looking at the K-th word of row I only,
+      and the corresponding pivot rows are ORed into it.
+
+   Step 2 gives the same result as the row-at-a-time algorithm,
+   because whether pivot k is applied to row I depends only on the
+   bits of block K in it.  It reads each row once per block instead
+   of once per pivot, and rows are independent of each other, so
+   step 2 is split between several threads.
+
+   To reduce the number of ORs in step 2, the pivots of a block are
+   split in groups of GROUP_BITS, and for each group a table of ORs of
+   all its 2^GROUP_BITS subsets is built after step 1 (the "Four
+   Russians" method).  Each row then needs at most one OR per group. */
+
+#define GROUP_BITS 8
+#define GROUP_SIZE (1 << GROUP_BITS)
+#define GROUPS     (BITS_PER_WORD / GROUP_BITS)
+
+#if defined __GNUC__ && !defined __STRICT_ANSI__
+typedef depmap_word_t depmap_vector_t
+           __attribute__ ((vector_size (32), aligned (sizeof(depmap_word_t))));
+# define VECTOR_WORDS (sizeof(depmap_vector_t) / sizeof(depmap_word_t))
+#endif
+
+/* Compute DST |= SRC over N words */
+static void
+row_or(depmap_word_t *dst, depmap_word_t const *src, size_t n)
+{
+     size_t i = 0;
+#ifdef VECTOR_WORDS
+     for (; i + VECTOR_WORDS <= n; i += VECTOR_WORDS)
+	  *(depmap_vector_t *)(dst + i) |= *(depmap_vector_t const *)(src + i);
+#endif
+     for (; i < n; i++)
+	  dst[i] |= src[i];
+}
+
+/* Return the number of pivots in block BLK */
+static size_t
+block_size(cflow_depmap_t dmap, size_t blk)
+{
+     size_t n = dmap->nrows - blk * BITS_PER_WORD;
+     return n > BITS_PER_WORD ? BITS_PER_WORD : n;
+}
+
+/* Step 1: close the pivot rows of block BLK and fill the subset
+   tables TAB */
+static void
+closure_pivots(cflow_depmap_t dmap, size_t blk, depmap_word_t *tab)
+{
+     size_t base = blk * BITS_PER_WORD;
+     size_t last = block_size(dmap, blk);
+     size_t rowlen = dmap->rowlen;
+     size_t k, i, g;
+     
+     for (k = 0; k < last; k++) {
+	  depmap_word_t *pivot = depmap_rowptr(dmap, base + k);
+	  for (i = 0; i < last; i++) {
+	       depmap_word_t *rowp = depmap_rowptr(dmap, base + i);
+	       if (BITISSET(rowp, base + k))
+		    row_or(rowp, pivot, rowlen);
+	  }
+     }
+
+     for (g = 0; g * GROUP_BITS < last; g++) {
+	  depmap_word_t *t = tab + g * GROUP_SIZE * rowlen;
+	  
+	  memset(t, 0, rowlen * sizeof(t[0]));
+	  for (i = 1; i < GROUP_SIZE; i++) {
+	       depmap_word_t *dst = t + i * rowlen;
+
+	       /* Subset I is subset I without its lowest bit, plus the
+		  pivot corresponding to that bit */
+	       for (k = 0; !(i & (1 << k)); k++)
+		    ;
+	       memcpy(dst, t + (i & (i - 1)) * rowlen, rowlen * sizeof(t[0]));
+	       k += g * GROUP_BITS;
+	       if (k < last)
+		    row_or(dst, depmap_rowptr(dmap, base + k), rowlen);
+	  }
+     }
+}
+
+/* Apply pivots of the block number BLK to row ROW */
+static void
+closure_row(cflow_depmap_t dmap, size_t blk, depmap_word_t const *tab,
+	    size_t row)
 {
-     transitive_closure(dmap->r, dmap->nrows);
+     depmap_word_t *rowp = depmap_rowptr(dmap, row);
+     size_t base = blk * BITS_PER_WORD;
+     size_t last = block_size(dmap, blk);
+     depmap_word_t mask, applied;
+     size_t k, g;
+     
+     /* Find out which pivots are applied */
+     mask = rowp[blk];
+     applied = 0;
+     for (k = 0; k < last; k++) {
+	  if (mask & WORDBIT(k)) {
+	       applied |= WORDBIT(k);
+	       mask |= depmap_rowptr(dmap, base + k)[blk];
+	  }
+     }
+
+     /* Apply them */
+     for (g = 0; applied; g++, applied >>= GROUP_BITS) {
+	  size_t i = applied & (GROUP_SIZE - 1);
+	  if (i)
+	       row_or(rowp, tab + (g * GROUP_SIZE + i) * dmap->rowlen,
+		      dmap->rowlen);
+     }
 }
 
+/* Step 2: update rows FROM..TO-1, except the pivot rows of block BLK */
+static void
+closure_rows(cflow_depmap_t dmap, size_t blk, depmap_word_t const *tab,
+	     size_t from, size_t to)
+{
+     size_t i;
+     
+     for (i = from; i < to; i++)
+	  if (i / BITS_PER_WORD != blk)
+	       closure_row(dmap, blk, tab, i);
+}
+
+static depmap_word_t *
+alloc_tables(cflow_depmap_t dmap)
+{
+     return xcalloc(GROUPS * GROUP_SIZE * dmap->rowlen,
+		    sizeof(depmap_word_t));
+}
+
+/* Threads */
+
+struct closure_state {
+     cflow_depmap_t dmap;
+     depmap_word_t *tab;           /* Subset tables */
+     size_t nblocks;               /* Number of pivot blocks */
+     unsigned nthreads;            /* Number of threads */
+     /* Barrier */
+     pthread_mutex_t mutex;
+     pthread_cond_t cond;
+     unsigned waiting;             /* Number of threads waiting on it */
+     unsigned long generation;     /* Incremented each time it opens */
+};
+
+struct closure_thread {
+     struct closure_state *state;
+     pthread_t tid;
+     size_t from, to;              /* Rows processed by this thread */
+};
+
+static void
+closure_barrier(struct closure_state *st)
+{
+     pthread_mutex_lock(&st->mutex);
+     if (++st->waiting == st->nthreads) {
+	  st->waiting = 0;
+	  st->generation++;
+	  pthread_cond_broadcast(&st->cond);
+     } else {
+	  unsigned long gen = st->generation;
+	  while (gen == st->generation)
+	       pthread_cond_wait(&st->cond, &st->mutex);
+     }
+     pthread_mutex_unlock(&st->mutex);
+}
+
+static void *
+closure_thread(void *data)
+{
+     struct closure_thread *thr = data;
+     struct closure_state *st = thr->state;
+     size_t blk;
+
+     for (blk = 0; blk < st->nblocks; blk++) {
+	  if (thr->from == 0)
+	       closure_pivots(st->dmap, blk, st->tab);
+	  closure_barrier(st);
+	  closure_rows(st->dmap, blk, st->tab, thr->from, thr->to);
+	  closure_barrier(st);
+     }
+     return NULL;
+}
+
+/* Compute transitive closure of DMAP using up to NTHREADS threads */
+void
+depmap_tc(cflow_depmap_t dmap, unsigned nthreads)
+{
+     size_t nblocks = WORDSIZE(dmap->nrows);
+     size_t blk, i, chunk;
+     int rc;
+     struct closure_state st;
+     struct closure_thread *thr;
+     depmap_word_t *tab = alloc_tables(dmap);
+     
+     if (nthreads > dmap->nrows / BITS_PER_WORD)
+	  nthreads = dmap->nrows / BITS_PER_WORD;
+     if (nthreads <= 1) {
+	  for (blk = 0; blk < nblocks; blk++) {
+	       closure_pivots(dmap, blk, tab);
+	       closure_rows(dmap, blk, tab, 0, dmap->nrows);
+	  }
+	  free(tab);
+	  return;
+     }
+
+     st.dmap = dmap;
+     st.tab = tab;
+     st.nblocks = nblocks;
+     st.nthreads = nthreads;
+     st.waiting = 0;
+     st.generation = 0;
+     pthread_mutex_init(&st.mutex, NULL);
+     pthread_cond_init(&st.cond, NULL);
+
+     thr = xcalloc(nthreads, sizeof(thr[0]));
+     chunk = (dmap->nrows + nthreads - 1) / nthreads;
+     for (i = 0; i < nthreads; i++) {
+	  thr[i].state = &st;
+	  thr[i].from = i * chunk;
+	  thr[i].to = thr[i].from + chunk;
+	  if (thr[i].to > dmap->nrows)
+	       thr[i].to = dmap->nrows;
+     }
+     for (i = 1; i < nthreads; i++)
+	  if ((rc = pthread_create(&thr[i].tid, NULL, closure_thread, &thr[i])))
+	       error(EX_FATAL, rc, _("cannot create thread"));
+     closure_thread(&thr[0]);
+     for (i = 1; i < nthreads; i++)
+	  pthread_join(thr[i].tid, NULL);
+
+     pthread_mutex_destroy(&st.mutex);
+     pthread_cond_destroy(&st.cond);
+     free(thr);
+     free(tab);
+}
@@ -0,0 +1,241 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Call depth and stack usage report.
+
+   For each function, the length of the longest call chain starting
+   at it is computed by dynamic programming over the condensation of
+   the call graph.  Components are numbered in reverse topological
+   order, so processing them in increasing order guarantees that all
+   callees of a component are done before it.  A call cycle is
+   collapsed into a single step of the chain, and all functions that
+   can reach it are flagged as recursive: their depth is unbounded.
+
+   If frame sizes of the functions are known (--stack-usage), the
+   maximum sum of frame sizes along a call chain is computed the same
+   way, giving an upper bound of the stack usage, unless recursion is
+   involved. */
+
+struct linked_list *stack_usage_files; /* Arguments of --stack-usage */
+
+#define DEPTH_RECURSIVE  0x01      /* Recursion below this function */
+#define DEPTH_DYNAMIC    0x02      /* Dynamic stack allocation below it */
+#define DEPTH_INCOMPLETE 0x04      /* Some frame sizes are not known */
+
+static size_t *frame_size;         /* Frame size of each function */
+static char *frame_flags;          /* 0, DEPTH_DYNAMIC or
+				      DEPTH_INCOMPLETE, if not known */
+
+static Symbol **sorted;            /* Functions, sorted by name */
+
+static int
+compare_names(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     return strcmp((*sa)->name, (*sb)->name);
+}
+
+static void
+set_frame_size(size_t n, size_t size, int flags)
+{
+     if (frame_flags[n] == DEPTH_INCOMPLETE || frame_size[n] < size)
+	  frame_size[n] = size;
+     frame_flags[n] = (frame_flags[n] & ~DEPTH_INCOMPLETE) | flags;
+}
+
+/* Process a line of a stack usage file.  GCC -fstack-usage writes
+   lines of the form
+
+     FILE:LINE:COLUMN:NAME   SIZE   QUALIFIERS
+
+   where QUALIFIERS is "static", "dynamic" or "dynamic,bounded".  A
+   line of the form "NAME SIZE" is accepted as well. */
+static void
+stack_usage_line(const char *file, int line, int wordc, char **wordv,
+		 void *data)
+{
+     char *name, *loc, *p;
+     size_t size, len, i, lo, hi, count;
+     int flags = 0;
+     Symbol key, *keyp = &key;
+
+     if (wordc < 2) {
+	  error(0, 0, _("%s:%d: expected function name and frame size"),
+		file, line);
+	  return;
+     }
+     size = strtoul(wordv[1], &p, 10);
+     if (*p) {
+	  error(0, 0, _("%s:%d: invalid frame size"), file, line);
+	  return;
+     }
+     if (wordc > 2 && strncmp(wordv[2], "dynamic", 7) == 0)
+	  flags = DEPTH_DYNAMIC;
+
+     loc = wordv[0];
+     name = strrchr(loc, ':');
+     if (name) {
+	  name++;
+	  /* Get the length of the file name */
+	  for (len = 0, p = loc; p < name && *p != ':'; p++)
+	       len++;
+     } else {
+	  name = loc;
+	  len = 0;
+     }
+
+     /* Find functions with this name */
+     key.name = name;
+     lo = 0;
+     hi = call_graph.nfunctions;
+     while (lo < hi) {
+	  i = (lo + hi) / 2;
+	  if (compare_names(&sorted[i], &keyp) < 0)
+	       lo = i + 1;
+	  else
+	       hi = i;
+     }
+     for (hi = lo; hi < call_graph.nfunctions
+		   && strcmp(sorted[hi]->name, name) == 0; hi++)
+	  ;
+
+     /* If there are several ones (static functions), use the one
+	defined in the same file, if any */
+     count = 0;
+     if (hi - lo > 1 && len > 0) {
+	  for (i = lo; i < hi; i++)
+	       if (sorted[i]->source
+		   && strlen(sorted[i]->source) == len
+		   && memcmp(sorted[i]->source, loc, len) == 0) {
+		    set_frame_size(sorted[i]->ord, size, flags);
+		    count++;
+	       }
+     }
+     if (count == 0)
+	  for (i = lo; i < hi; i++)
+	       set_frame_size(sorted[i]->ord, size, flags);
+}
+
+static int
+compare_symbols(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     int rc = strcmp((*sa)->name, (*sb)->name);
+     if (rc == 0)
+	  rc = strcmp((*sa)->source, (*sb)->source);
+     return rc;
+}
+
+void
+depth_output()
+{
+     size_t nscc, nfunc = call_graph.nfunctions;
+     size_t *depth, *stack, c, i, num;
+     char *flags;
+     int have_frames = stack_usage_files != NULL;
+     Symbol **symbols;
+
+     graph_condense();
+     nscc = call_graph.nscc;
+
+     sorted = xcalloc(nfunc + 1, sizeof(sorted[0]));
+     memcpy(sorted, call_graph.sym, nfunc * sizeof(sorted[0]));
+     qsort(sorted, nfunc, sizeof(sorted[0]), compare_names);
+
+     if (have_frames) {
+	  struct linked_list_entry *p;
+
+	  frame_size = xcalloc(nfunc + 1, sizeof(frame_size[0]));
+	  frame_flags = xzalloc(nfunc + 1);
+	  memset(frame_flags, DEPTH_INCOMPLETE, nfunc);
+	  for (p = linked_list_head(stack_usage_files); p; p = p->next)
+	       read_word_file(p->data, stack_usage_line, NULL);
+     }
+
+     depth = xcalloc(nscc + 1, sizeof(depth[0]));
+     stack = xcalloc(nscc + 1, sizeof(stack[0]));
+     flags = xzalloc(nscc + 1);
+
+     for (c = 0; c < nscc; c++) {
+	  size_t best_depth = 0, best_stack = 0;
+	  int is_function = 0;
+
+	  /* Own weight of the component */
+	  for (i = call_graph.scc_nodes.off[c];
+	       i < call_graph.scc_nodes.off[c+1]; i++) {
+	       size_t n = call_graph.scc_nodes.tab[i];
+	       if (n >= nfunc)
+		    continue;
+	       is_function = 1;
+	       if (graph_node_recursive(n))
+		    flags[c] |= DEPTH_RECURSIVE;
+	       if (have_frames) {
+		    flags[c] |= frame_flags[n];
+		    if (frame_size[n] > stack[c])
+			 stack[c] = frame_size[n];
+	       }
+	  }
+
+	  /* Longest chain among the callees */
+	  for (i = call_graph.scc_callee.off[c];
+	       i < call_graph.scc_callee.off[c+1]; i++) {
+	       size_t d = call_graph.scc_callee.tab[i];
+	       if (depth[d] > best_depth)
+		    best_depth = depth[d];
+	       if (stack[d] > best_stack)
+		    best_stack = stack[d];
+	       flags[c] |= flags[d];
+	  }
+
+	  depth[c] = best_depth + is_function;
+	  stack[c] += best_stack;
+     }
+
+     /* Print the report */
+     symbols = xcalloc(nfunc + 1, sizeof(symbols[0]));
+     for (i = num = 0; i < nfunc; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  if (sym->source && include_symbol(sym))
+	       symbols[num++] = sym;
+     }
+     qsort(symbols, num, sizeof(symbols[0]), compare_symbols);
+     for (i = 0; i < num; i++) {
+	  c = call_graph.scc[symbols[i]->ord];
+	  fprintf(outfile, "%s %lu", symbols[i]->name,
+		  (unsigned long) depth[c]);
+	  if (have_frames)
+	       fprintf(outfile, " %lu", (unsigned long) stack[c]);
+	  if (flags[c] & DEPTH_RECURSIVE)
+	       fprintf(outfile, " recursive");
+	  if (flags[c] & DEPTH_DYNAMIC)
+	       fprintf(outfile, " dynamic");
+	  if (flags[c] & DEPTH_INCOMPLETE)
+	       fprintf(outfile, " incomplete");
+	  fprintf(outfile, "\n");
+     }
+
+     free(symbols);
+     free(depth);
+     free(stack);
+     free(flags);
+     free(sorted);
+     free(frame_size);
+     free(frame_flags);
+}
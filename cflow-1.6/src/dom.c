@@ -0,0 +1,185 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Dominators.
+
+   Function A dominates function B if every call chain from the start
+   function to B passes through A.  The immediate dominators are computed
+   by the Lengauer-Tarjan algorithm with path compression, which runs in
+   O(E log V) time.  Both the depth-first search and the path
+   compression are iterative, so that long call chains don't exhaust
+   the stack. */
+
+struct dom_state {
+     int (*sel)(Symbol *);         /* Node selector */
+     size_t *dfnum;                /* DFS number + 1, 0 if not reached */
+     size_t *vertex;               /* Node with the given DFS number */
+     size_t *parent;               /* Parent in the DFS tree */
+     size_t *semi;                 /* DFS number of the semidominator */
+     size_t *ancestor;             /* Forest built by link() */
+     size_t *label;                /* Node with the minimal semi on the
+				      path to the forest root */
+     size_t *bucket;               /* First node of the bucket */
+     size_t *next;                 /* Next node in the same bucket */
+     size_t *stack;                /* Work stack */
+};
+
+static size_t
+dom_dfs(struct dom_state *s, size_t root)
+{
+     size_t *pos = xcalloc(call_graph.nodes + 1, sizeof(pos[0]));
+     size_t sp = 0, count = 0;
+
+     s->stack[sp++] = root;
+     s->dfnum[root] = ++count;
+     s->vertex[0] = root;
+     s->parent[root] = GRAPH_NONE;
+     pos[root] = call_graph.callee.off[root];
+     while (sp) {
+	  size_t v = s->stack[sp-1];
+
+	  if (pos[v] < call_graph.callee.off[v+1]) {
+	       size_t w = call_graph.callee.tab[pos[v]++];
+	       if (!s->dfnum[w] && s->sel(call_graph.sym[w])) {
+		    s->vertex[count] = w;
+		    s->dfnum[w] = ++count;
+		    s->parent[w] = v;
+		    pos[w] = call_graph.callee.off[w];
+		    s->stack[sp++] = w;
+	       }
+	  } else
+	       sp--;
+     }
+     free(pos);
+     return count;
+}
+
+/* Compress the ancestor path of V */
+static void
+dom_compress(struct dom_state *s, size_t v)
+{
+     size_t sp = 0;
+
+     while (s->ancestor[s->ancestor[v]] != GRAPH_NONE) {
+	  s->stack[sp++] = v;
+	  v = s->ancestor[v];
+     }
+     while (sp) {
+	  size_t a;
+
+	  v = s->stack[--sp];
+	  a = s->ancestor[v];
+	  if (s->semi[s->label[a]] < s->semi[s->label[v]])
+	       s->label[v] = s->label[a];
+	  s->ancestor[v] = s->ancestor[a];
+     }
+}
+
+static size_t
+dom_eval(struct dom_state *s, size_t v)
+{
+     if (s->ancestor[v] == GRAPH_NONE)
+	  return v;
+     dom_compress(s, v);
+     return s->label[v];
+}
+
+/* Compute the immediate dominators of the nodes reachable from ROOT
+   over the callee edges, traversing only the nodes whose symbols satisfy
+   SEL.  Store them in a newly allocated array in *RETURN_IDOM, indexed
+   by node.  The entries for ROOT and for unreachable nodes are
+   GRAPH_NONE.  Return the number of reachable nodes. */
+size_t
+graph_dominators(size_t root, int (*sel)(Symbol *), size_t **return_idom)
+{
+     struct dom_state s;
+     size_t n = call_graph.nodes + 1, count, i, j;
+     size_t *idom;
+
+     idom = xcalloc(n, sizeof(idom[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  idom[i] = GRAPH_NONE;
+     *return_idom = idom;
+     if (!sel(call_graph.sym[root]))
+	  return 0;
+
+     s.sel = sel;
+     s.dfnum = xcalloc(n, sizeof(s.dfnum[0]));
+     s.vertex = xcalloc(n, sizeof(s.vertex[0]));
+     s.parent = xcalloc(n, sizeof(s.parent[0]));
+     s.semi = xcalloc(n, sizeof(s.semi[0]));
+     s.ancestor = xcalloc(n, sizeof(s.ancestor[0]));
+     s.label = xcalloc(n, sizeof(s.label[0]));
+     s.bucket = xcalloc(n, sizeof(s.bucket[0]));
+     s.next = xcalloc(n, sizeof(s.next[0]));
+     s.stack = xcalloc(n, sizeof(s.stack[0]));
+
+     count = dom_dfs(&s, root);
+     for (i = 0; i < count; i++) {
+	  size_t v = s.vertex[i];
+	  s.semi[v] = i;
+	  s.ancestor[v] = GRAPH_NONE;
+	  s.label[v] = v;
+	  s.bucket[v] = GRAPH_NONE;
+     }
+
+     for (i = count - 1; i > 0; i--) {
+	  size_t w = s.vertex[i], p = s.parent[w], v;
+
+	  /* Compute the semidominator of W */
+	  for (j = call_graph.caller.off[w]; j < call_graph.caller.off[w+1];
+	       j++) {
+	       size_t u;
+
+	       v = call_graph.caller.tab[j];
+	       if (!s.dfnum[v])
+		    continue;
+	       u = dom_eval(&s, v);
+	       if (s.semi[u] < s.semi[w])
+		    s.semi[w] = s.semi[u];
+	  }
+	  s.next[w] = s.bucket[s.vertex[s.semi[w]]];
+	  s.bucket[s.vertex[s.semi[w]]] = w;
+	  s.ancestor[w] = p;
+
+	  /* Implicitly compute the immediate dominators of the nodes
+	     whose semidominator is P */
+	  for (v = s.bucket[p]; v != GRAPH_NONE; v = s.next[v]) {
+	       size_t u = dom_eval(&s, v);
+	       idom[v] = s.semi[u] < s.semi[v] ? u : p;
+	  }
+	  s.bucket[p] = GRAPH_NONE;
+     }
+
+     for (i = 1; i < count; i++) {
+	  size_t w = s.vertex[i];
+	  if (idom[w] != s.vertex[s.semi[w]])
+	       idom[w] = idom[idom[w]];
+     }
+
+     free(s.dfnum);
+     free(s.vertex);
+     free(s.parent);
+     free(s.semi);
+     free(s.ancestor);
+     free(s.label);
+     free(s.bucket);
+     free(s.next);
+     free(s.stack);
+     return count;
+}
@@ -0,0 +1,134 @@
+/* This file is part of GNU cflow
+   Copyright (C) 1997-2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+#include <parser.h>
+
+/* Settings shared by the cflow program and libcflow.  The program sets
+   them from the command line, the helper processes of the library from
+   the context they parse (see libcflow.c). */
+
+int debug;              /* debug level */
+char *outname = "-";    /* default output file name */
+int print_option = 0;   /* what to print. */
+int verbose;            /* be verbose on output */
+int use_indentation;    /* Rely on indentation,
+			 * i.e. suppose the function body
+                         * is necessarily surrounded by the curly braces
+			 * in the first column
+                         */
+int record_defines;     /* Record macro definitions */
+int strict_ansi;        /* Assume sources to be written in ANSI C */
+int print_line_numbers; /* Print line numbers */
+int print_levels;       /* Print level number near every branch */
+int print_as_tree;      /* Print as tree */
+int brief_listing;      /* Produce short listing */
+int reverse_tree;       /* Generate reverse tree */
+int max_depth;          /* The depth at which the flowgraph is cut off */
+int emacs_option;       /* Format and check for use with Emacs cflow-mode */ 
+int omit_arguments_option;    /* Omit arguments from function declaration string */
+int omit_symbol_names_option; /* Omit symbol name from symbol declaration string */
+int print_cycles_option;      /* Print call cycle numbers of recursive functions */
+
+int symbol_map;  /* A bitmap of symbols included in the graph. */
+
+char *level_indent[] = { NULL, NULL };
+char *level_end[] = { "", "" };
+char *level_begin = "";
+
+int preprocess_option = 0; /* Do they want to preprocess sources? */
+
+char *start_name = "main"; /* Name of start symbol */
+struct linked_list *start_list; /* Start symbols given with -m and
+				   --roots-file, if any */
+int all_functions;
+int threads;         /* Number of threads for graph computations,
+			0 for one per CPU */
+
+int
+globals_only()
+{
+     return !(symbol_map & SM_STATIC);
+}
+
+int
+include_symbol(Symbol *sym)
+{
+     int type = 0;
+     
+     if (!sym)
+	  return 0;
+     
+     if (sym->type == SymIdentifier) {
+	  if (sym->name[0] == '_' && !(symbol_map & SM_UNDERSCORE))
+	       return 0;
+
+	  if (sym->storage == StaticStorage)
+	       type |= SM_STATIC;
+	  if (sym->arity == -1 && sym->storage != AutoStorage)
+	       type |= SM_DATA;
+	  else if (sym->arity >= 0)
+	       type |= SM_FUNCTIONS;
+
+	  if (!sym->source)
+	       type |= SM_UNDEFINED;
+	  
+     } else if (sym->type == SymToken) {
+	  if (sym->token_type == TYPE && sym->source)
+	       type |= SM_TYPEDEF;
+	  else
+	       return 0;
+     }
+     return (symbol_map & type) == type;
+}
+
+/* Return the number of threads to use for graph computations */
+unsigned
+thread_count()
+{
+     long n = threads;
+
+     if (n == 0) {
+	  n = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+	  n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+     }
+     return n > 1 ? n : 1;
+}
+
+void
+xalloc_die(void)
+{
+     error(EX_FATAL, ENOMEM, _("Exiting"));
+     abort();
+}
+
+void
+init()
+{
+     if (level_indent[0] == NULL) 
+	  level_indent[0] = "    "; /* 4 spaces */
+     if (level_indent[1] == NULL)
+	  level_indent[1] = level_indent[0];
+     if (level_end[0] == NULL)
+	  level_end[0] = "";
+     if (level_end[1] == NULL)
+	  level_end[1] = "";
+     
+     init_lex(debug > 2);
+     init_parse();
+}
@@ -17,7 +17,7 @@
 #include <cflow.h>
 
 void
-print_function_name(Symbol *sym, int has_subtree)
+print_function_name(Symbol *sym, int has_subtree, size_t id)
 {
      fprintf(outfile, "%s", sym->name);
      if (sym->arity >= 0)
@@ -31,8 +31,14 @@ print_function_name(Symbol *sym, int has_subtree)
 	  fprintf(outfile, " (recursive: see %d)", sym->active-1);
 	  return;
      }
-     if (sym->recursive)
-	  fprintf(outfile, " (R)");
+     if (sym->recursive) {
+	  if (print_cycles_option)
+	       fprintf(outfile, " (R:%d)", sym->recursive);
+	  else
+	       fprintf(outfile, " (R)");
+     }
+     if (id)
+	  fprintf(outfile, " #%lu", (unsigned long) id);
      if (!print_as_tree && has_subtree)
 	  fprintf(outfile, ":");
 }
@@ -41,18 +47,25 @@ print_function_name(Symbol *sym, int has_subtree)
 static int
 print_symbol(FILE *outfile, int line, struct output_symbol *s)
 {
-     int has_subtree = s->direct ? 
- 	                  s->sym->callee != NULL :
-	                  s->sym->caller != NULL;
+     int has_subtree = !s->leaf && (s->direct ? 
+				    s->sym->callee != NULL :
+				    s->sym->caller != NULL);
      
      print_level(s->level, s->last);
-     print_function_name(s->sym, has_subtree);
+     if (s->ref) {
+	  print_function_name(s->sym, 0, 0);
+	  fprintf(outfile, " [see #%lu]", (unsigned long) s->id);
+	  return 1;
+     }
+     print_function_name(s->sym, has_subtree, s->id);
+     if (s->weight)
+	  fprintf(outfile, " [weight %lu]", (unsigned long) s->weight);
 	  
-     if (brief_listing) {
+     if (brief_listing && !compress_tree) {
 	  if (s->sym->expand_line) {
 	       fprintf(outfile, " [see %d]", s->sym->expand_line);
 	       return 1;
-	  } else if (s->sym->callee)
+	  } else if (s->sym->callee && !s->leaf)
 	       s->sym->expand_line = line;
      }
      return 0;
@@ -0,0 +1,509 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Frozen call graph.
+
+   Once all sources are parsed, the caller and callee lists of the
+   symbols are converted into a compressed sparse row representation.
+   Each symbol participating in the graph gets an ordinal number (ord),
+   which indexes the offset arrays.  Functions come first, in the order
+   returned by collect_functions, so that nodes 0..nfunctions-1 are
+   exactly the functions of the program. */
+
+struct cflow_graph call_graph;
+
+static int
+is_other_identifier(Symbol *sym)
+{
+     return sym->type == SymIdentifier && !symbol_is_function(sym);
+}
+
+static size_t node_alloc;
+
+/* Return the node number of SYM, or GRAPH_NONE if it is not part
+   of the graph */
+size_t
+graph_node(Symbol *sym)
+{
+     if (sym->ord < call_graph.nodes && call_graph.sym[sym->ord] == sym)
+	  return sym->ord;
+     return GRAPH_NONE;
+}
+
+static void
+add_node(Symbol *sym)
+{
+     if (graph_node(sym) != GRAPH_NONE)
+	  return;
+     if (call_graph.nodes == node_alloc)
+	  call_graph.sym = x2nrealloc(call_graph.sym, &node_alloc,
+				      sizeof(call_graph.sym[0]));
+     sym->ord = call_graph.nodes;
+     call_graph.sym[call_graph.nodes++] = sym;
+}
+
+static void
+add_list_nodes(struct linked_list *list)
+{
+     struct linked_list_entry *p;
+
+     for (p = linked_list_head(list); p; p = p->next)
+	  add_node(p->data);
+}
+
+/* Fill in the adjacency arrays ADJ from the list selected by GETLIST */
+static void
+build_adjacency(struct graph_adjacency *adj,
+		struct linked_list *(*getlist)(Symbol *))
+{
+     size_t i, n;
+
+     adj->off = xcalloc(call_graph.nodes + 1, sizeof(adj->off[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  adj->off[i+1] = adj->off[i]
+	                   + linked_list_size(getlist(call_graph.sym[i]));
+     adj->tab = xcalloc(adj->off[call_graph.nodes] + 1,
+			sizeof(adj->tab[0]));
+     for (i = n = 0; i < call_graph.nodes; i++) {
+	  struct linked_list_entry *p;
+
+	  for (p = linked_list_head(getlist(call_graph.sym[i])); p;
+	       p = p->next)
+	       adj->tab[n++] = ((Symbol*)p->data)->ord;
+     }
+}
+
+static struct linked_list *
+get_callee(Symbol *sym)
+{
+     return sym->callee;
+}
+
+static struct linked_list *
+get_caller(Symbol *sym)
+{
+     return sym->caller;
+}
+
+static int
+compare_node_names(const void *ap, const void *bp)
+{
+     size_t a = *(const size_t *)ap;
+     size_t b = *(const size_t *)bp;
+     int rc = strcmp(call_graph.sym[a]->name, call_graph.sym[b]->name);
+
+     if (rc == 0)
+	  rc = a < b ? -1 : a > b;
+     return rc;
+}
+
+void
+graph_freeze()
+{
+     Symbol **symbols;
+     size_t i, num;
+
+     /* Functions first */
+     num = collect_functions(&symbols);
+     for (i = 0; i < num; i++)
+	  add_node(symbols[i]);
+     free(symbols);
+     call_graph.nfunctions = call_graph.nodes;
+
+     /* Then the rest of identifiers */
+     num = collect_symbols(&symbols, is_other_identifier, 0);
+     for (i = 0; i < num; i++)
+	  add_node(symbols[i]);
+     free(symbols);
+
+     /* Finally, symbols that are no longer in the symbol table, but
+	are still referred to from the graph (e.g. static variables of
+	already processed compilation units). */
+     for (i = 0; i < call_graph.nodes; i++) {
+	  add_list_nodes(call_graph.sym[i]->callee);
+	  add_list_nodes(call_graph.sym[i]->caller);
+     }
+
+     build_adjacency(&call_graph.callee, get_callee);
+     build_adjacency(&call_graph.caller, get_caller);
+
+     call_graph.by_name = xcalloc(call_graph.nodes + 1,
+				  sizeof(call_graph.by_name[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  call_graph.by_name[i] = i;
+     qsort(call_graph.by_name, call_graph.nodes,
+	   sizeof(call_graph.by_name[0]), compare_node_names);
+}
+
+/* Store in *PTAB the address of the list of nodes adjacent to SYM in
+   ADJ and return its length. */
+size_t
+graph_adjacent(struct graph_adjacency *adj, Symbol *sym, size_t **ptab)
+{
+     size_t n = graph_node(sym);
+
+     if (n == GRAPH_NONE) {
+	  *ptab = NULL;
+	  return 0;
+     }
+     *ptab = adj->tab + adj->off[n];
+     return adj->off[n+1] - adj->off[n];
+}
+
+/* Compute strongly connected components of the graph using Tarjan's
+   algorithm.  The depth-first search is iterative, so that deeply
+   nested call chains don't exhaust the stack.
+
+   On return, call_graph.scc[N] contains the number of the component
+   node N belongs to.  Components are numbered in reverse topological
+   order: if there is an edge from component A to a different
+   component B, then A > B. */
+void
+graph_scc()
+{
+     size_t nodes = call_graph.nodes;
+     size_t *index;     /* DFS discovery index + 1, 0 if not visited */
+     size_t *low;       /* Lowest index reachable from the node */
+     size_t *pos;       /* Next edge to examine */
+     size_t *stack;     /* Tarjan's node stack */
+     size_t *frame;     /* DFS call stack */
+     char *onstack;
+     size_t counter = 0, sp = 0, fp = 0, root, i;
+     
+     if (call_graph.scc)
+	  return;
+     call_graph.scc = xcalloc(nodes + 1, sizeof(call_graph.scc[0]));
+     call_graph.nscc = 0;
+     
+     index = xcalloc(nodes + 1, sizeof(index[0]));
+     low = xcalloc(nodes + 1, sizeof(low[0]));
+     pos = xcalloc(nodes + 1, sizeof(pos[0]));
+     stack = xcalloc(nodes + 1, sizeof(stack[0]));
+     frame = xcalloc(nodes + 1, sizeof(frame[0]));
+     onstack = xzalloc(nodes + 1);
+
+     for (root = 0; root < nodes; root++) {
+	  if (index[root])
+	       continue;
+	  frame[fp++] = root;
+	  while (fp) {
+	       size_t v = frame[fp-1];
+	       size_t end = call_graph.callee.off[v+1];
+	       
+	       if (!index[v]) {
+		    index[v] = low[v] = ++counter;
+		    pos[v] = call_graph.callee.off[v];
+		    stack[sp++] = v;
+		    onstack[v] = 1;
+	       }
+
+	       while (pos[v] < end) {
+		    size_t w = call_graph.callee.tab[pos[v]];
+		    if (!index[w])
+			 break;
+		    if (onstack[w] && index[w] < low[v])
+			 low[v] = index[w];
+		    pos[v]++;
+	       }
+
+	       if (pos[v] < end) {
+		    /* Descend into an unvisited callee */
+		    frame[fp++] = call_graph.callee.tab[pos[v]++];
+		    continue;
+	       }
+
+	       if (low[v] == index[v]) {
+		    size_t w;
+		    do {
+			 w = stack[--sp];
+			 onstack[w] = 0;
+			 call_graph.scc[w] = call_graph.nscc;
+		    } while (w != v);
+		    call_graph.nscc++;
+	       }
+	       
+	       if (--fp) {
+		    size_t u = frame[fp-1];
+		    if (low[v] < low[u])
+			 low[u] = low[v];
+	       }
+	  }
+     }
+
+     free(index);
+     free(low);
+     free(pos);
+     free(stack);
+     free(frame);
+     free(onstack);
+
+     /* Compute component sizes */
+     call_graph.scc_size = xcalloc(call_graph.nscc + 1,
+				   sizeof(call_graph.scc_size[0]));
+     for (i = 0; i < nodes; i++)
+	  call_graph.scc_size[call_graph.scc[i]]++;
+}
+
+/* Return true if node N is part of a call cycle */
+int
+graph_node_recursive(size_t n)
+{
+     size_t i;
+     
+     if (call_graph.scc_size[call_graph.scc[n]] > 1)
+	  return 1;
+     for (i = call_graph.callee.off[n]; i < call_graph.callee.off[n+1]; i++)
+	  if (call_graph.callee.tab[i] == n)
+	       return 1;
+     return 0;
+}
+
+struct cycle {
+     size_t scc;                   /* Component number */
+     Symbol *rep;                  /* Representative: the member with
+				      the lexicographically smallest name */
+};
+
+static int
+cycle_compare(const void *a, const void *b)
+{
+     struct cycle const *ca = a;
+     struct cycle const *cb = b;
+     return strcmp(ca->rep->name, cb->rep->name);
+}
+
+/* Mark recursive functions among the COUNT nodes listed in NODES, or
+   among all functions if NODES is NULL.  Each function that is part of
+   a call cycle gets its `recursive' member set to the number of that
+   cycle.  Cycles are numbered from 1, in lexicographical order of their
+   representatives, so that the numbering doesn't depend on the order
+   in which symbols were collected. */
+void
+graph_mark_recursive(size_t *nodes, size_t count)
+{
+     struct cycle *cycles;
+     size_t *cycle_index;
+     size_t i, ncycles = 0;
+
+#define NODE(i) (nodes ? nodes[i] : (i))
+     graph_scc();
+     if (!nodes)
+	  count = call_graph.nfunctions;
+     cycles = xcalloc(call_graph.nscc + 1, sizeof(cycles[0]));
+     cycle_index = xcalloc(call_graph.nscc + 1, sizeof(cycle_index[0]));
+     for (i = 0; i < call_graph.nscc; i++)
+	  cycle_index[i] = GRAPH_NONE;
+     
+     for (i = 0; i < count; i++) {
+	  size_t n = NODE(i);
+	  size_t c = call_graph.scc[n];
+	  Symbol *sym = call_graph.sym[n];
+	  
+	  if (n >= call_graph.nfunctions || !graph_node_recursive(n))
+	       continue;
+	  if (cycle_index[c] == GRAPH_NONE) {
+	       cycle_index[c] = ncycles;
+	       cycles[ncycles].scc = c;
+	       cycles[ncycles].rep = sym;
+	       ncycles++;
+	  } else if (strcmp(sym->name, cycles[cycle_index[c]].rep->name) < 0)
+	       cycles[cycle_index[c]].rep = sym;
+     }
+
+     qsort(cycles, ncycles, sizeof(cycles[0]), cycle_compare);
+     for (i = 0; i < ncycles; i++)
+	  cycle_index[cycles[i].scc] = i;
+
+     for (i = 0; i < count; i++) {
+	  size_t n = NODE(i);
+	  if (n < call_graph.nfunctions && graph_node_recursive(n))
+	       call_graph.sym[n]->recursive =
+		    cycle_index[call_graph.scc[n]] + 1;
+     }
+#undef NODE
+     
+     free(cycles);
+     free(cycle_index);
+}
+
+/* Find the nodes of the symbols named NAME.  Unlike lookup(), this
+   finds static functions as well, which are removed from the symbol
+   table at the end of their compilation units.  The nodes are looked
+   up by binary search in call_graph.by_name.  Store them in a newly
+   allocated array in *RETURN_NODES and return their number. */
+size_t
+graph_find(const char *name, size_t **return_nodes)
+{
+     size_t lo = 0, hi = call_graph.nodes, i, count;
+     size_t *nodes;
+
+     /* Find the first entry of by_name not less than NAME */
+     while (lo < hi) {
+	  size_t mid = lo + (hi - lo) / 2;
+	  if (strcmp(call_graph.sym[call_graph.by_name[mid]]->name, name) < 0)
+	       lo = mid + 1;
+	  else
+	       hi = mid;
+     }
+     for (i = lo; i < call_graph.nodes
+		  && strcmp(call_graph.sym[call_graph.by_name[i]]->name,
+			    name) == 0; i++)
+	  ;
+     count = i - lo;
+     nodes = xcalloc(count + 1, sizeof(nodes[0]));
+     memcpy(nodes, call_graph.by_name + lo, count * sizeof(nodes[0]));
+     *return_nodes = nodes;
+     return count;
+}
+
+/* Collect the nodes reachable from ROOT over the edges of ADJ (callee
+   or caller ones), in breadth-first order.  Nodes whose symbols don't
+   satisfy SEL are neither collected nor traversed.  If DEPTH is not 0,
+   only nodes at distance less than DEPTH from ROOT are collected.
+   Store the nodes in a newly allocated array in *RETURN_NODES and
+   return their number. */
+size_t
+graph_reachable(struct graph_adjacency *adj, Symbol *root, int depth,
+		int (*sel)(Symbol *), size_t **return_nodes)
+{
+     size_t *queue, *dist;
+     size_t head = 0, tail = 0, i;
+     size_t n = graph_node(root);
+
+     queue = xcalloc(call_graph.nodes + 1, sizeof(queue[0]));
+     if (n == GRAPH_NONE || !sel(root)) {
+	  *return_nodes = queue;
+	  return 0;
+     }
+     
+     dist = xcalloc(call_graph.nodes + 1, sizeof(dist[0]));
+     queue[tail++] = n;
+     dist[n] = 1;
+     while (head < tail) {
+	  size_t v = queue[head++];
+
+	  if (depth && dist[v] >= depth)
+	       continue;
+	  for (i = adj->off[v]; i < adj->off[v+1]; i++) {
+	       size_t w = adj->tab[i];
+	       if (!dist[w] && sel(call_graph.sym[w])) {
+		    dist[w] = dist[v] + 1;
+		    queue[tail++] = w;
+	       }
+	  }
+     }
+     free(dist);
+     *return_nodes = queue;
+     return tail;
+}
+
+/* Build the condensation of the call graph: a DAG whose nodes are the
+   strongly connected components.  Fills call_graph.scc_nodes (nodes
+   of each component, in increasing order), call_graph.scc_callee and
+   call_graph.scc_caller (edges between distinct components, without
+   duplicates). */
+void
+graph_condense()
+{
+     size_t nscc, i, j, n;
+     size_t *last;
+     struct graph_adjacency *members = &call_graph.scc_nodes;
+     
+     graph_scc();
+     if (members->off)
+	  return;
+     nscc = call_graph.nscc;
+
+     members->off = xcalloc(nscc + 1, sizeof(members->off[0]));
+     for (i = 0; i < nscc; i++)
+	  members->off[i+1] = members->off[i] + call_graph.scc_size[i];
+     members->tab = xcalloc(call_graph.nodes + 1, sizeof(members->tab[0]));
+     last = xcalloc(nscc + 1, sizeof(last[0]));
+     memcpy(last, members->off, nscc * sizeof(last[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  members->tab[last[call_graph.scc[i]]++] = i;
+
+     for (n = 0; n < 2; n++) {
+	  struct graph_adjacency *adj = n ? &call_graph.caller
+	                                  : &call_graph.callee;
+	  struct graph_adjacency *cadj = n ? &call_graph.scc_caller
+	                                   : &call_graph.scc_callee;
+	  size_t count = 0, c;
+
+	  /* LAST[C] is the last component that got an edge to C */
+	  for (i = 0; i < nscc; i++)
+	       last[i] = GRAPH_NONE;
+	  cadj->off = xcalloc(nscc + 1, sizeof(cadj->off[0]));
+	  cadj->tab = NULL;
+	  for (c = 0; c < nscc; c++) {
+	       for (i = members->off[c]; i < members->off[c+1]; i++) {
+		    size_t v = members->tab[i];
+		    for (j = adj->off[v]; j < adj->off[v+1]; j++) {
+			 size_t d = call_graph.scc[adj->tab[j]];
+			 if (d != c && last[d] != c) {
+			      last[d] = c;
+			      count++;
+			 }
+		    }
+	       }
+	       cadj->off[c+1] = count;
+	  }
+	  
+	  cadj->tab = xcalloc(count + 1, sizeof(cadj->tab[0]));
+	  for (i = 0; i < nscc; i++)
+	       last[i] = GRAPH_NONE;
+	  for (c = count = 0; c < nscc; c++) {
+	       for (i = members->off[c]; i < members->off[c+1]; i++) {
+		    size_t v = members->tab[i];
+		    for (j = adj->off[v]; j < adj->off[v+1]; j++) {
+			 size_t d = call_graph.scc[adj->tab[j]];
+			 if (d != c && last[d] != c) {
+			      last[d] = c;
+			      cadj->tab[count++] = d;
+			 }
+		    }
+	       }
+	  }
+     }
+     free(last);
+}
+
+static void
+free_adjacency(struct graph_adjacency *adj)
+{
+     free(adj->off);
+     free(adj->tab);
+}
+
+/* Free the call graph and return it to the unfrozen state */
+void
+graph_free()
+{
+     reach_index_free();
+     free(call_graph.sym);
+     free(call_graph.by_name);
+     free_adjacency(&call_graph.callee);
+     free_adjacency(&call_graph.caller);
+     free(call_graph.scc);
+     free(call_graph.scc_size);
+     free_adjacency(&call_graph.scc_nodes);
+     free_adjacency(&call_graph.scc_callee);
+     free_adjacency(&call_graph.scc_caller);
+     memset(&call_graph, 0, sizeof(call_graph));
+     node_alloc = 0;
+}
@@ -0,0 +1,146 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+#include <parser.h>
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/wait.h>
+#endif
+
+/* Parallel preprocessing.
+
+   With --cpp and --jobs=N, up to N preprocessors run ahead of the
+   parser, each writing the preprocessed text of its file to a
+   temporary file.  When the parser gets to a file, it waits for its
+   preprocessor to finish and scans the output.  The files are parsed
+   in the order of the command line, by the same code as in the
+   sequential run, so the output doesn't depend on the number of jobs.
+   The preprocessors write their diagnostics to stderr directly, so
+   these come out in an order that depends on the scheduling.
+
+   Without --cpp, the scanner and the parser are all there is to do,
+   and they share the symbol table, so the files are parsed one after
+   another and --jobs has no effect. */
+
+int jobs = 1;                      /* Number of preprocessors */
+
+#ifndef _WIN32
+struct pp_job {
+     char *name;                   /* Input file name */
+     int soft;                     /* Failure to read it is an error */
+     int error;                    /* errno, if the file cannot be opened */
+     pid_t pid;                    /* Preprocessor PID */
+     FILE *fp;                     /* Its output */
+};
+
+/* Start the preprocessor of JOB */
+static void
+job_start(struct pp_job *job)
+{
+     char *command;
+     FILE *fp = fopen(job->name, "r");
+
+     if (!fp) {
+	  job->error = errno;
+	  return;
+     }
+     fclose(fp);
+     command = pp_command(job->name);
+     job->fp = tmpfile();
+     if (!job->fp)
+	  error(EX_FATAL, errno, _("cannot create temporary file"));
+     fflush(stdout);
+     fflush(stderr);
+     job->pid = fork();
+     if (job->pid == -1)
+	  error(EX_FATAL, errno, _("cannot fork"));
+     if (job->pid == 0) {
+	  /* Run the preprocessor, as popen would do */
+	  if (dup2(fileno(job->fp), 1) == -1)
+	       _exit(127);
+	  execl("/bin/sh", "sh", "-c", command, (char*) NULL);
+	  _exit(127);
+     }
+     free(command);
+}
+
+/* Wait for the preprocessor of JOB to finish and prepare for parsing
+   its output.  Return 0 on success. */
+static int
+job_finish(struct pp_job *job)
+{
+     int status;
+
+     if (job->error) {
+	  error(0, job->error, _("cannot open `%s'"), job->name);
+	  return 1;
+     }
+     while (waitpid(job->pid, &status, 0) == -1)
+	  if (errno != EINTR)
+	       error(EX_FATAL, errno, _("waitpid failed"));
+     rewind(job->fp);
+     /* Its exit status is ignored, as that of pp_open() is */
+     source_file(job->name, job->fp);
+     return 0;
+}
+#endif
+
+/* Parse the input files from LIST and ARGV, preprocessing them in
+   parallel.  Failure to read a file from ARGV is reported by the return
+   value. */
+int
+parse_parallel(struct linked_list *list, int argc, char **argv)
+{
+     int status = EX_OK;
+#ifndef _WIN32
+     struct pp_job *job;
+     struct linked_list_entry *p;
+     size_t count, i, started = 0;
+
+     count = linked_list_size(list) + argc;
+     job = xcalloc(count + 1, sizeof(job[0]));
+     for (p = linked_list_head(list), i = 0; p; p = p->next, i++)
+	  job[i].name = p->data;
+     for (; i < count; i++) {
+	  job[i].name = *argv++;
+	  job[i].soft = 1;
+     }
+
+     for (i = 0; i < count; i++) {
+	  while (started < count && started < i + jobs)
+	       job_start(&job[started++]);
+	  if (job_finish(&job[i]) == 0)
+	       yyparse();
+	  else if (job[i].soft)
+	       status = EX_SOFT;
+     }
+     free(job);
+#else
+     struct linked_list_entry *p;
+
+     for (p = linked_list_head(list); p; p = p->next)
+	  if (source(p->data) == 0)
+	       yyparse();
+     while (argc--) {
+	  if (source(*argv++) == 0)
+	       yyparse();
+	  else
+	       status = EX_SOFT;
+     }
+#endif
+     return status;
+}
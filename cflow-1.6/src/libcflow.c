@@ -0,0 +1,819 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+#include <libcflow.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/* Library interface.
+
+   The scanner, the parser and the symbol table keep their state in
+   global variables.  To give each context a state of its own, the
+   sources of a context are parsed by a helper process, forked by
+   cflow_finish.  The helper parses the sources, sends the symbols and
+   edges of the call graph to the library and then serves the render
+   requests of the context until it is freed.  Contexts are thus
+   independent of each other and can be processed in parallel, and a
+   fatal error (e.g. memory exhaustion) terminates the helper, which
+   the library reports as a failure of the call.
+
+   The library and its helper talk over a socket pair.  The helper
+   first sends a graph_header, followed by the string table, the
+   symbols and the callee and caller adjacencies.  Each render request
+   is a render_request followed by the driver and start names, and is
+   answered by a render_reply followed by the output.
+
+   The library itself never calls the x* allocation functions nor
+   error(), so that it doesn't terminate the host program.  The helper
+   runs the cflow code as is: its exit handler makes it terminate
+   without running the handlers of the host. */
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+#define NO_STRING ((size_t)-1)
+
+struct cflow_source {
+     char *name;                   /* File name */
+     char *buf;                    /* Its contents, or NULL to read the
+				      file */
+     size_t len;                   /* Length of buf */
+};
+
+struct cflow_ctx {
+     cflow_ctx *next;              /* Next context in ctx_list */
+     pthread_mutex_t lock;         /* Serializes the requests */
+     struct cflow_source *src;     /* Sources */
+     size_t nsrc;                  /* Number of sources */
+     size_t src_max;               /* Number of allocated entries */
+     char *preprocessor;           /* Preprocessor command, or NULL */
+     int finished;                 /* cflow_finish succeeded */
+     int failed;                   /* cflow_finish failed */
+     int status;                   /* Its return value */
+     pid_t pid;                    /* Helper process, or -1 */
+     int fd;                       /* Socket connected to it, or -1 */
+     char *strings;                /* Strings of the symbols */
+     struct cflow_symbol *sym;     /* Symbols */
+     size_t nsym;                  /* Number of symbols */
+     struct graph_adjacency callee; /* Edges, indexed by symbol */
+     struct graph_adjacency caller;
+};
+
+struct graph_header {
+     int status;                   /* Return value of cflow_finish */
+     size_t nsym;                  /* Number of symbols */
+     size_t strsize;               /* Size of the string table */
+     size_t ncallee;               /* Number of callee edges */
+     size_t ncaller;               /* Number of caller edges */
+};
+
+struct graph_symbol {
+     size_t name;                  /* Offsets in the string table, or */
+     size_t source;                /* NO_STRING */
+     size_t decl;
+     int line;
+     int flags;
+};
+
+struct render_request {
+     int flags;                    /* CFLOW_RENDER_ flags */
+     size_t driver_len;            /* Length of the driver name */
+     size_t start_len;             /* Length of the start name, or
+				      NO_STRING */
+};
+
+struct render_reply {
+     int status;                   /* 0 on success */
+     size_t len;                   /* Length of the output */
+};
+
+/* All contexts, so that each helper can close the sockets of the
+   contexts other than its own */
+static pthread_mutex_t ctx_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static cflow_ctx *ctx_list;
+
+/* Read LEN bytes from FD into BUF.  Return 0 on success, -1 on error
+   or end of file. */
+static int
+read_full(int fd, void *buf, size_t len)
+{
+     char *p = buf;
+
+     while (len) {
+	  ssize_t n = read(fd, p, len);
+	  if (n < 0) {
+	       if (errno == EINTR)
+		    continue;
+	       return -1;
+	  }
+	  if (n == 0) {
+	       errno = EIO;
+	       return -1;
+	  }
+	  p += n;
+	  len -= n;
+     }
+     return 0;
+}
+
+/* Write LEN bytes from BUF to socket FD.  Return 0 on success, -1 on
+   error.  The library doesn't get SIGPIPE if the helper is gone. */
+static int
+write_full(int fd, const void *buf, size_t len)
+{
+     const char *p = buf;
+
+     while (len) {
+	  ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+	  if (n < 0) {
+	       if (errno == EINTR)
+		    continue;
+	       return -1;
+	  }
+	  p += n;
+	  len -= n;
+     }
+     return 0;
+}
+
+/* Allocate an array of N elements of SIZE bytes, or return NULL */
+static void *
+alloc_array(size_t n, size_t size)
+{
+     if (n > ((size_t)-1 - 1) / size) {
+	  errno = ENOMEM;
+	  return NULL;
+     }
+     return malloc((n + 1) * size);
+}
+
+cflow_ctx *
+cflow_ctx_create()
+{
+     cflow_ctx *ctx = calloc(1, sizeof(*ctx));
+
+     if (!ctx)
+	  return NULL;
+     pthread_mutex_init(&ctx->lock, NULL);
+     ctx->pid = -1;
+     ctx->fd = -1;
+     pthread_mutex_lock(&ctx_list_lock);
+     ctx->next = ctx_list;
+     ctx_list = ctx;
+     pthread_mutex_unlock(&ctx_list_lock);
+     return ctx;
+}
+
+/* Terminate the helper of CTX, if any */
+static void
+stop_helper(cflow_ctx *ctx)
+{
+     if (ctx->fd != -1) {
+	  /* The helper exits on end of file */
+	  close(ctx->fd);
+	  ctx->fd = -1;
+     }
+     if (ctx->pid != -1) {
+	  while (waitpid(ctx->pid, NULL, 0) == -1 && errno == EINTR)
+	       ;
+	  ctx->pid = -1;
+     }
+}
+
+void
+cflow_ctx_free(cflow_ctx *ctx)
+{
+     cflow_ctx **pp;
+     size_t i;
+
+     if (!ctx)
+	  return;
+     pthread_mutex_lock(&ctx_list_lock);
+     for (pp = &ctx_list; *pp != ctx; pp = &(*pp)->next)
+	  ;
+     *pp = ctx->next;
+     pthread_mutex_unlock(&ctx_list_lock);
+     stop_helper(ctx);
+     pthread_mutex_destroy(&ctx->lock);
+     for (i = 0; i < ctx->nsrc; i++) {
+	  free(ctx->src[i].name);
+	  free(ctx->src[i].buf);
+     }
+     free(ctx->src);
+     free(ctx->preprocessor);
+     free(ctx->strings);
+     free(ctx->sym);
+     free(ctx->callee.off);
+     free(ctx->callee.tab);
+     free(ctx->caller.off);
+     free(ctx->caller.tab);
+     free(ctx);
+}
+
+int
+cflow_set_preprocessor(cflow_ctx *ctx, const char *command)
+{
+     char *copy = NULL;
+
+     if (ctx->finished || ctx->failed) {
+	  errno = EINVAL;
+	  return -1;
+     }
+     if (command && (copy = strdup(command)) == NULL)
+	  return -1;
+     free(ctx->preprocessor);
+     ctx->preprocessor = copy;
+     return 0;
+}
+
+/* Add a source named NAME to CTX.  Return it, or NULL on error. */
+static struct cflow_source *
+new_source(cflow_ctx *ctx, const char *name)
+{
+     struct cflow_source *src;
+
+     if (ctx->finished || ctx->failed) {
+	  errno = EINVAL;
+	  return NULL;
+     }
+     if (ctx->nsrc == ctx->src_max) {
+	  size_t n = ctx->src_max ? 2 * ctx->src_max : 16;
+	  src = alloc_array(n, sizeof(src[0]));
+	  if (!src)
+	       return NULL;
+	  if (ctx->nsrc)
+	       memcpy(src, ctx->src, ctx->nsrc * sizeof(src[0]));
+	  free(ctx->src);
+	  ctx->src = src;
+	  ctx->src_max = n;
+     }
+     src = &ctx->src[ctx->nsrc];
+     src->name = strdup(name);
+     if (!src->name)
+	  return NULL;
+     src->buf = NULL;
+     src->len = 0;
+     ctx->nsrc++;
+     return src;
+}
+
+int
+cflow_add_file(cflow_ctx *ctx, const char *name)
+{
+     return new_source(ctx, name) ? 0 : -1;
+}
+
+int
+cflow_add_buffer(cflow_ctx *ctx, const char *name, const char *buf,
+		 size_t len)
+{
+     struct cflow_source *src;
+     char *copy;
+
+     if (len == (size_t)-1 || (copy = malloc(len + 1)) == NULL) {
+	  errno = ENOMEM;
+	  return -1;
+     }
+     memcpy(copy, buf, len);
+     copy[len] = 0;
+     src = new_source(ctx, name);
+     if (!src) {
+	  free(copy);
+	  return -1;
+     }
+     src->buf = copy;
+     src->len = len;
+     return 0;
+}
+
+
+/* Helper process */
+
+/* Initialize the global state of the helper */
+static void
+lib_init()
+{
+     register_output("gnu", gnu_output_handler, NULL);
+     register_output("posix", posix_output_handler, NULL);
+     init();
+}
+
+/* Select the settings for the given kind of output */
+static void
+set_output_mode(int xref)
+{
+     print_option = xref ? PRINT_XREF : PRINT_TREE;
+     symbol_map = SM_FUNCTIONS|SM_STATIC|SM_UNDEFINED;
+     if (xref)
+	  symbol_map &= ~SM_STATIC;
+     omit_symbol_names_option = 0;
+}
+
+static int loaded_print_option;    /* Settings the sources were parsed */
+static int loaded_symbol_map;      /* with */
+static int loaded_omit_names;
+static int state_used;             /* Global state contains a parsed
+				      context */
+
+/* Parse the sources of CTX into the global state, unless they are
+   already there.  The parser depends on the output settings, so the
+   sources are parsed again if these have changed.  Return 0 on
+   success, 1 if some files could not be read. */
+static int
+load_context(cflow_ctx *ctx)
+{
+     size_t i;
+     int status = 0;
+
+     if (state_used
+	 && loaded_print_option == print_option
+	 && loaded_symbol_map == symbol_map
+	 && loaded_omit_names == omit_symbol_names_option)
+	  return ctx->status;
+     if (state_used) {
+	  graph_free();
+	  delete_all_symbols();
+	  reset_lex();
+	  reset_parse();
+     }
+     state_used = 1;
+
+     preprocess_option = ctx->preprocessor != NULL;
+     pp_bin = ctx->preprocessor;
+     input_file_count = 0;
+     for (i = 0; i < ctx->nsrc; i++) {
+	  struct cflow_source *src = &ctx->src[i];
+
+	  if (src->buf) {
+	       source_buffer(src->name, src->buf, src->len);
+	       yyparse();
+	  } else if (source(src->name) == 0)
+	       yyparse();
+	  else
+	       status = 1;
+     }
+     graph_freeze();
+
+     loaded_print_option = print_option;
+     loaded_symbol_map = symbol_map;
+     loaded_omit_names = omit_symbol_names_option;
+     return status;
+}
+
+static int
+compare_nodes(const void *ap, const void *bp)
+{
+     Symbol *a = call_graph.sym[*(size_t const *)ap];
+     Symbol *b = call_graph.sym[*(size_t const *)bp];
+     int rc = strcmp(a->name, b->name);
+
+     if (rc == 0) {
+	  rc = strcmp(a->source ? a->source : "", b->source ? b->source : "");
+	  if (rc == 0)
+	       rc = a->def_line - b->def_line;
+     }
+     return rc;
+}
+
+static size_t
+save_string(struct obstack *stk, const char *str)
+{
+     size_t off = obstack_object_size(stk);
+
+     if (!str)
+	  return NO_STRING;
+     obstack_grow0(stk, str, strlen(str));
+     return off;
+}
+
+/* Store in DST the edges of ADJ between the nodes selected by INDEX.
+   ORDER lists the N selected nodes; INDEX maps nodes to their positions
+   in it, or to CFLOW_NONE. */
+static void
+copy_adjacency(struct graph_adjacency *dst, struct graph_adjacency *adj,
+	       size_t *order, size_t *index, size_t n)
+{
+     size_t i, j, k = 0;
+
+     dst->off = xcalloc(n + 1, sizeof(dst->off[0]));
+     dst->tab = xcalloc(adj->off[call_graph.nodes] + 1, sizeof(dst->tab[0]));
+     for (i = 0; i < n; i++) {
+	  size_t v = order[i];
+	  for (j = adj->off[v]; j < adj->off[v+1]; j++)
+	       if (index[adj->tab[j]] != CFLOW_NONE)
+		    dst->tab[k++] = index[adj->tab[j]];
+	  dst->off[i+1] = k;
+     }
+}
+
+/* Send the symbols and edges of the call graph to the library over
+   FD.  STATUS is the return value of cflow_finish. */
+static void
+send_graph(int fd, int status)
+{
+     struct graph_header hdr;
+     struct graph_symbol *gsym;
+     struct graph_adjacency callee, caller;
+     struct obstack stk;
+     size_t *order, *index, i, n;
+     char *strings;
+
+     graph_scc();
+     order = xcalloc(call_graph.nodes + 1, sizeof(order[0]));
+     index = xcalloc(call_graph.nodes + 1, sizeof(index[0]));
+     for (i = n = 0; i < call_graph.nodes; i++) {
+	  index[i] = CFLOW_NONE;
+	  if (include_symbol(call_graph.sym[i]))
+	       order[n++] = i;
+     }
+     qsort(order, n, sizeof(order[0]), compare_nodes);
+
+     obstack_init(&stk);
+     gsym = xcalloc(n + 1, sizeof(gsym[0]));
+     for (i = 0; i < n; i++) {
+	  Symbol *sym = call_graph.sym[order[i]];
+	  struct graph_symbol *gs = &gsym[i];
+
+	  index[order[i]] = i;
+	  gs->name = save_string(&stk, sym->name);
+	  gs->source = save_string(&stk, sym->source);
+	  gs->line = sym->source ? sym->def_line : -1;
+	  gs->decl = save_string(&stk, sym->decl);
+	  if (symbol_is_function(sym))
+	       gs->flags |= CFLOW_SYMBOL_FUNCTION;
+	  if (sym->storage == StaticStorage)
+	       gs->flags |= CFLOW_SYMBOL_STATIC;
+	  if (graph_node_recursive(order[i]))
+	       gs->flags |= CFLOW_SYMBOL_RECURSIVE;
+     }
+     copy_adjacency(&callee, &call_graph.callee, order, index, n);
+     copy_adjacency(&caller, &call_graph.caller, order, index, n);
+
+     hdr.status = status;
+     hdr.nsym = n;
+     hdr.strsize = obstack_object_size(&stk);
+     hdr.ncallee = callee.off[n];
+     hdr.ncaller = caller.off[n];
+     strings = obstack_finish(&stk);
+     if (write_full(fd, &hdr, sizeof(hdr))
+	 || write_full(fd, strings, hdr.strsize)
+	 || write_full(fd, gsym, n * sizeof(gsym[0]))
+	 || write_full(fd, callee.off, (n + 1) * sizeof(callee.off[0]))
+	 || write_full(fd, callee.tab, hdr.ncallee * sizeof(callee.tab[0]))
+	 || write_full(fd, caller.off, (n + 1) * sizeof(caller.off[0]))
+	 || write_full(fd, caller.tab, hdr.ncaller * sizeof(caller.tab[0])))
+	  _exit(EX_FATAL);
+
+     obstack_free(&stk, NULL);
+     free(gsym);
+     free(callee.off);
+     free(callee.tab);
+     free(caller.off);
+     free(caller.tab);
+     free(order);
+     free(index);
+}
+
+/* Read a string of LEN bytes from FD, or return NULL if LEN is
+   NO_STRING */
+static char *
+read_string(int fd, size_t len)
+{
+     char *str;
+
+     if (len == NO_STRING)
+	  return NULL;
+     str = xmalloc(len + 1);
+     if (read_full(fd, str, len))
+	  _exit(EX_FATAL);
+     str[len] = 0;
+     return str;
+}
+
+/* Serve the render request REQ of CTX, read from FD */
+static void
+render_request(cflow_ctx *ctx, int fd, struct render_request *req)
+{
+     struct render_reply reply;
+     char *driver, *start, *text = NULL;
+     size_t size = 0;
+     FILE *fp;
+
+     driver = read_string(fd, req->driver_len);
+     start = read_string(fd, req->start_len);
+     if (select_output_driver(driver))
+	  reply.status = 1;
+     else {
+	  set_output_mode(req->flags & CFLOW_RENDER_XREF);
+	  start_name = start ? start : "main";
+	  reverse_tree = (req->flags & CFLOW_RENDER_REVERSE) != 0;
+	  brief_listing = (req->flags & CFLOW_RENDER_BRIEF) != 0;
+	  print_line_numbers = (req->flags & CFLOW_RENDER_NUMBER) != 0;
+	  all_functions = (req->flags & CFLOW_RENDER_ALL) != 0;
+	  /* The driver may change the settings */
+	  output_init();
+	  load_context(ctx);
+	  fp = open_memstream(&text, &size);
+	  if (!fp)
+	       xalloc_die();
+	  output_stream(fp);
+	  if (fclose(fp))
+	       xalloc_die();
+	  reply.status = 0;
+     }
+     reply.len = size;
+     if (write_full(fd, &reply, sizeof(reply))
+	 || write_full(fd, text, size))
+	  _exit(EX_FATAL);
+     free(text);
+     free(driver);
+     free(start);
+}
+
+/* The helper must not run the exit handlers of the host program.  This
+   one is registered last, so it runs first. */
+static void
+helper_exit()
+{
+     _exit(EX_FATAL);
+}
+
+/* Main function of the helper process of CTX, connected to the library
+   over FD */
+static void
+helper_main(cflow_ctx *ctx, int fd)
+{
+     cflow_ctx *p;
+     struct render_request req;
+     int null_fd;
+
+     /* Close the sockets of the other contexts, so that their helpers
+	get end of file when these are freed */
+     for (p = ctx_list; p; p = p->next)
+	  if (p->fd != -1)
+	       close(p->fd);
+     atexit(helper_exit);
+     /* The helper doesn't use stdout, but error() flushes it: make sure
+	the output buffered by the host doesn't get written twice */
+     null_fd = open("/dev/null", O_WRONLY);
+     if (null_fd != -1) {
+	  dup2(null_fd, 1);
+	  close(null_fd);
+     }
+
+     lib_init();
+     set_output_mode(0);
+     ctx->status = load_context(ctx);
+     send_graph(fd, ctx->status);
+     while (read_full(fd, &req, sizeof(req)) == 0)
+	  render_request(ctx, fd, &req);
+     _exit(EX_OK);
+}
+
+
+/* Library side */
+
+/* Start the helper process of CTX.  Return 0 on success, -1 on
+   error. */
+static int
+start_helper(cflow_ctx *ctx)
+{
+     int sv[2];
+     pid_t pid;
+
+     /* Hold ctx_list_lock until the helper is forked, so that it gets a
+	consistent list of the sockets to close */
+     pthread_mutex_lock(&ctx_list_lock);
+     if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+	  pthread_mutex_unlock(&ctx_list_lock);
+	  return -1;
+     }
+     fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+     fcntl(sv[1], F_SETFD, FD_CLOEXEC);
+     pid = fork();
+     if (pid == 0) {
+	  close(sv[0]);
+	  helper_main(ctx, sv[1]);
+     }
+     if (pid == -1) {
+	  int ec = errno;
+	  close(sv[0]);
+	  close(sv[1]);
+	  pthread_mutex_unlock(&ctx_list_lock);
+	  errno = ec;
+	  return -1;
+     }
+     close(sv[1]);
+     ctx->pid = pid;
+     ctx->fd = sv[0];
+     pthread_mutex_unlock(&ctx_list_lock);
+     return 0;
+}
+
+/* Read an array of N elements of SIZE bytes from FD.  Return it, or
+   NULL on error. */
+static void *
+read_array(int fd, size_t n, size_t size)
+{
+     void *tab = alloc_array(n, size);
+
+     if (tab && read_full(fd, tab, n * size)) {
+	  free(tab);
+	  return NULL;
+     }
+     return tab;
+}
+
+/* Read the call graph sent by the helper of CTX.  Return 0 on success,
+   -1 on error. */
+static int
+receive_graph(cflow_ctx *ctx)
+{
+     struct graph_header hdr;
+     struct graph_symbol *gsym;
+     size_t i;
+
+     if (read_full(ctx->fd, &hdr, sizeof(hdr)))
+	  return -1;
+     ctx->strings = read_array(ctx->fd, hdr.strsize, 1);
+     if (!ctx->strings)
+	  return -1;
+     gsym = read_array(ctx->fd, hdr.nsym, sizeof(gsym[0]));
+     if (!gsym)
+	  return -1;
+     ctx->sym = alloc_array(hdr.nsym, sizeof(ctx->sym[0]));
+     if (!ctx->sym) {
+	  free(gsym);
+	  return -1;
+     }
+     for (i = 0; i < hdr.nsym; i++) {
+	  struct cflow_symbol *cs = &ctx->sym[i];
+
+#define STRING(off) ((off) == NO_STRING ? NULL : ctx->strings + (off))
+	  cs->name = STRING(gsym[i].name);
+	  cs->source = STRING(gsym[i].source);
+	  cs->decl = STRING(gsym[i].decl);
+#undef STRING
+	  cs->line = gsym[i].line;
+	  cs->flags = gsym[i].flags;
+     }
+     free(gsym);
+     ctx->nsym = hdr.nsym;
+     ctx->status = hdr.status;
+     if (!(ctx->callee.off = read_array(ctx->fd, hdr.nsym + 1,
+					sizeof(size_t)))
+	 || !(ctx->callee.tab = read_array(ctx->fd, hdr.ncallee,
+					   sizeof(size_t)))
+	 || !(ctx->caller.off = read_array(ctx->fd, hdr.nsym + 1,
+					   sizeof(size_t)))
+	 || !(ctx->caller.tab = read_array(ctx->fd, hdr.ncaller,
+					   sizeof(size_t))))
+	  return -1;
+     return 0;
+}
+
+int
+cflow_finish(cflow_ctx *ctx)
+{
+     int rc;
+
+     pthread_mutex_lock(&ctx->lock);
+     if (ctx->finished)
+	  rc = ctx->status;
+     else if (ctx->failed) {
+	  errno = EIO;
+	  rc = -1;
+     } else if (start_helper(ctx) || receive_graph(ctx)) {
+	  int ec = errno;
+	  stop_helper(ctx);
+	  ctx->failed = 1;
+	  ctx->nsym = 0;
+	  errno = ec;
+	  rc = -1;
+     } else {
+	  ctx->finished = 1;
+	  rc = ctx->status;
+     }
+     pthread_mutex_unlock(&ctx->lock);
+     return rc;
+}
+
+size_t
+cflow_symbol_count(cflow_ctx *ctx)
+{
+     return ctx->nsym;
+}
+
+const struct cflow_symbol *
+cflow_symbol(cflow_ctx *ctx, size_t n)
+{
+     return n < ctx->nsym ? &ctx->sym[n] : NULL;
+}
+
+size_t
+cflow_lookup(cflow_ctx *ctx, const char *name)
+{
+     size_t lo = 0, hi = ctx->nsym;
+
+     /* Find the first symbol with that name */
+     while (lo < hi) {
+	  size_t mid = (lo + hi) / 2;
+	  if (strcmp(ctx->sym[mid].name, name) < 0)
+	       lo = mid + 1;
+	  else
+	       hi = mid;
+     }
+     if (lo < ctx->nsym && strcmp(ctx->sym[lo].name, name) == 0)
+	  return lo;
+     return CFLOW_NONE;
+}
+
+static size_t
+adjacent(cflow_ctx *ctx, struct graph_adjacency *adj, size_t n,
+	 const size_t **return_tab)
+{
+     if (n >= ctx->nsym) {
+	  *return_tab = NULL;
+	  return 0;
+     }
+     *return_tab = adj->tab + adj->off[n];
+     return adj->off[n+1] - adj->off[n];
+}
+
+size_t
+cflow_callees(cflow_ctx *ctx, size_t n, const size_t **return_tab)
+{
+     return adjacent(ctx, &ctx->callee, n, return_tab);
+}
+
+size_t
+cflow_callers(cflow_ctx *ctx, size_t n, const size_t **return_tab)
+{
+     return adjacent(ctx, &ctx->caller, n, return_tab);
+}
+
+int
+cflow_render(cflow_ctx *ctx, const char *driver, const char *start,
+	     int flags, FILE *fp)
+{
+     struct render_request req;
+     struct render_reply reply;
+     char *text;
+     int rc = -1;
+
+     pthread_mutex_lock(&ctx->lock);
+     if (!ctx->finished) {
+	  errno = EINVAL;
+	  goto out;
+     }
+     req.flags = flags;
+     req.driver_len = strlen(driver);
+     req.start_len = start ? strlen(start) : NO_STRING;
+     if (write_full(ctx->fd, &req, sizeof(req))
+	 || write_full(ctx->fd, driver, req.driver_len)
+	 || (start && write_full(ctx->fd, start, req.start_len))
+	 || read_full(ctx->fd, &reply, sizeof(reply)))
+	  goto fail;
+     if (reply.status) {
+	  errno = EINVAL;
+	  goto out;
+     }
+     text = read_array(ctx->fd, reply.len, 1);
+     if (!text)
+	  goto fail;
+     if (fwrite(text, 1, reply.len, fp) == reply.len)
+	  rc = 0;
+     else
+	  errno = EIO;
+     free(text);
+     goto out;
+
+fail:
+     /* The helper is gone, or the reply cannot be read in full */
+     if (errno != ENOMEM)
+	  errno = EIO;
+     stop_helper(ctx);
+     ctx->finished = 0;
+     ctx->failed = 1;
+out:
+     pthread_mutex_unlock(&ctx->lock);
+     return rc;
+}
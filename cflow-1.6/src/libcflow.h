@@ -0,0 +1,115 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#ifndef _LIBCFLOW_H
+#define _LIBCFLOW_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* Interface to the cflow parser and call graph.
+
+   A context collects the source files of a program, parses them and
+   keeps the resulting call graph:
+
+     cflow_ctx *ctx = cflow_ctx_create();
+     cflow_add_file(ctx, "main.c");
+     cflow_add_buffer(ctx, "gen.c", text, size);
+     cflow_finish(ctx);
+     for (i = 0; i < cflow_symbol_count(ctx); i++) ...
+     cflow_ctx_free(ctx);
+
+   Each context is parsed by a helper process of its own, forked by
+   cflow_finish and kept until the context is freed.  Different
+   contexts can thus be processed by different threads in parallel.
+   Calls on the same context are serialized.  The symbols and edges of
+   a finished context are copied into the calling process, so they can
+   be read by any number of threads at once.
+
+   Functions returning int return -1 on error and set errno: EINVAL
+   if the call is not valid for the context, ENOMEM if memory is
+   exhausted, and EIO if the helper failed (e.g. ran out of memory).
+   Errors never terminate the calling program.  Diagnostics about the
+   sources are written to stderr.
+
+   Only the cflow_ functions are exported by the library.  Link with
+   -lcflow -pthread. */
+
+typedef struct cflow_ctx cflow_ctx;
+
+#define CFLOW_NONE ((size_t)-1)
+
+/* Symbol flags */
+#define CFLOW_SYMBOL_FUNCTION  0x01   /* Symbol is a function */
+#define CFLOW_SYMBOL_STATIC    0x02   /* It has static storage */
+#define CFLOW_SYMBOL_RECURSIVE 0x04   /* It is part of a call cycle */
+
+struct cflow_symbol {
+     const char *name;             /* Identifier */
+     const char *source;           /* Source file, NULL if not defined */
+     int line;                     /* Definition line, -1 if not defined */
+     const char *decl;             /* Declaration, NULL if not known */
+     int flags;                    /* CFLOW_SYMBOL_ flags */
+};
+
+/* Render flags */
+#define CFLOW_RENDER_XREF      0x01   /* Cross-reference instead of tree */
+#define CFLOW_RENDER_REVERSE   0x02   /* Reverse tree (--reverse) */
+#define CFLOW_RENDER_BRIEF     0x04   /* Brief output (--brief) */
+#define CFLOW_RENDER_NUMBER    0x08   /* Print line numbers (--number) */
+#define CFLOW_RENDER_ALL       0x10   /* Trees of all functions (--all) */
+
+/* Create a context, or return NULL if memory is exhausted */
+cflow_ctx *cflow_ctx_create(void);
+void cflow_ctx_free(cflow_ctx *ctx);
+
+/* Preprocess the files added to CTX by COMMAND (e.g. "cpp -DNDEBUG").
+   Buffers are never preprocessed.  Sources and preprocessor can only
+   be set before cflow_finish. */
+int cflow_set_preprocessor(cflow_ctx *ctx, const char *command);
+
+/* Add the source file NAME to CTX */
+int cflow_add_file(cflow_ctx *ctx, const char *name);
+/* Add a source named NAME with the LEN bytes of text at BUF.  The text
+   is copied. */
+int cflow_add_buffer(cflow_ctx *ctx, const char *name,
+		     const char *buf, size_t len);
+
+/* Parse the sources of CTX and build its call graph.  Return 0 on
+   success, 1 if some of the files could not be read, and -1 on
+   error. */
+int cflow_finish(cflow_ctx *ctx);
+
+/* Symbols of the call graph, sorted by name and source file */
+size_t cflow_symbol_count(cflow_ctx *ctx);
+const struct cflow_symbol *cflow_symbol(cflow_ctx *ctx, size_t n);
+/* Return the index of the symbol NAME, or CFLOW_NONE */
+size_t cflow_lookup(cflow_ctx *ctx, const char *name);
+
+/* Store in *RETURN_TAB the indices of the symbols called by (called
+   from) symbol N, in the order the calls were first seen, and return
+   their number. */
+size_t cflow_callees(cflow_ctx *ctx, size_t n, const size_t **return_tab);
+size_t cflow_callers(cflow_ctx *ctx, size_t n, const size_t **return_tab);
+
+/* Write the call graph of CTX to FP, in the format of the output driver
+   DRIVER ("gnu" or "posix").  START is the start function, NULL meaning
+   "main".  Return 0 on success, and -1 on error, e.g. if CTX is not
+   finished or DRIVER is unknown. */
+int cflow_render(cflow_ctx *ctx, const char *driver, const char *start,
+		 int flags, FILE *fp);
+
+#endif
@@ -134,17 +134,6 @@ linked_list_iterate(struct linked_list **plist,
      *plist = list;
 }
 
-int
-data_in_list(void *data, struct linked_list *list)
-{
-     struct linked_list_entry *p;
-     
-     for (p = linked_list_head(list); p; p = p->next)
-	  if (p->data == data)
-	       return 1;
-     return 0;
-}
-
 size_t
 linked_list_size(struct linked_list *list)
 {
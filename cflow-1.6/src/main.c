@@ -51,7 +51,33 @@ enum option_code {
      OPT_OMIT_ARGUMENTS,
      OPT_NO_OMIT_ARGUMENTS,
      OPT_OMIT_SYMBOL_NAMES,
-     OPT_NO_OMIT_SYMBOL_NAMES
+     OPT_NO_OMIT_SYMBOL_NAMES,
+     OPT_CYCLES,
+     OPT_NO_CYCLES,
+     OPT_REACHES,
+     OPT_REACHES_FILE,
+     OPT_ROOTS_FILE,
+     OPT_PATH,
+     OPT_PATH_COUNT,
+     OPT_UNREACHABLE,
+     OPT_MAX_DEPTH_REPORT,
+     OPT_STACK_USAGE,
+     OPT_COMPRESS,
+     OPT_NO_COMPRESS,
+     OPT_LINES,
+     OPT_MAX_OUTPUT_LINES,
+     OPT_MAX_OUTPUT_BYTES,
+     OPT_NEIGHBORHOOD,
+     OPT_RADIUS,
+     OPT_EDGE_LIST,
+     OPT_IMPACTED_BY,
+     OPT_AGGREGATE,
+     OPT_DOMINATORS,
+     OPT_REACH_COUNTS,
+     OPT_GRAPH_STATS,
+     OPT_PREPROCESS_BATCH,
+     OPT_REACH_MATRIX,
+     OPT_THREADS
 };
 
 static struct argp_option options[] = {
@@ -104,7 +130,9 @@ static struct argp_option options[] = {
      { "symbol", 's', N_("SYMBOL:[=]TYPE"), 0,
        N_("Register SYMBOL with given TYPE, or define an alias (if := is used). Valid types are: keyword (or kw), modifier, qualifier, identifier, type, wrapper. Any unambiguous abbreviation of the above is also accepted"), GROUP_ID+1 },
      { "main", 'm', N_("NAME"), 0,
-       N_("Assume main function to be called NAME"), GROUP_ID+1 },
+       N_("Assume main function to be called NAME. If given several times, print a graph for each NAME"), GROUP_ID+1 },
+     { "roots-file", OPT_ROOTS_FILE, N_("FILE"), 0,
+       N_("Read names of start functions from FILE"), GROUP_ID+1 },
      { "no-main", OPT_NO_MAIN, NULL, 0,
        N_("There's no main function; print graphs for all functions in the program") },
      { "define", 'D', N_("NAME[=DEFN]"), 0,
@@ -119,6 +147,12 @@ static struct argp_option options[] = {
      { "no-preprocess", OPT_NO_PREPROCESS, NULL, OPTION_HIDDEN,
        "", GROUP_ID+1 },
      { "no-cpp", 0, NULL, OPTION_ALIAS|OPTION_HIDDEN, NULL, GROUP_ID+1 },
+     { "jobs", 'j', N_("NUMBER"), 0,
+       N_("With --cpp, preprocess up to NUMBER input files in parallel (the order of preprocessor diagnostics is not deterministic)"),
+       GROUP_ID+1 },
+     { "preprocess-batch", OPT_PREPROCESS_BATCH, N_("NUMBER"), 0,
+       N_("Pass up to NUMBER input files to each preprocessor invocation"),
+       GROUP_ID+1 },
 #undef GROUP_ID
 #define GROUP_ID 20          
      { NULL, 0, NULL, 0,
@@ -156,6 +190,69 @@ static struct argp_option options[] = {
        N_("* Do not print symbol names in declaration strings"), GROUP_ID+1 },
      { "no-omit-symbol-names", OPT_NO_OMIT_SYMBOL_NAMES, NULL, OPTION_HIDDEN,
        "", GROUP_ID+1 },
+     { "cycles", OPT_CYCLES, NULL, 0,
+       N_("* Mark recursive functions with the number of the call cycle they belong to"), GROUP_ID+1 },
+     { "no-cycles", OPT_NO_CYCLES, NULL, OPTION_HIDDEN,
+       "", GROUP_ID+1 },
+     { "compress", OPT_COMPRESS, NULL, 0,
+       N_("* Expand each subtree only once, refer to it by node number elsewhere"), GROUP_ID+1 },
+     { "no-compress", OPT_NO_COMPRESS, NULL, OPTION_HIDDEN,
+       "", GROUP_ID+1 },
+     { "lines", OPT_LINES, N_("START-END"), 0,
+       N_("Print only lines START through END of the call tree"), GROUP_ID+1 },
+     { "max-output-lines", OPT_MAX_OUTPUT_LINES, N_("NUMBER"), 0,
+       N_("Stop the call tree output after NUMBER lines"), GROUP_ID+1 },
+     { "max-output-bytes", OPT_MAX_OUTPUT_BYTES, N_("NUMBER"), 0,
+       N_("Stop the call tree output before it exceeds NUMBER bytes"),
+       GROUP_ID+1 },
+#undef GROUP_ID
+#define GROUP_ID 25
+     { NULL, 0, NULL, 0,
+       N_("Graph queries:"), GROUP_ID },
+     { "reaches", OPT_REACHES, N_("FROM:TO"), 0,
+       N_("Tell whether symbol TO is reachable from FROM"), GROUP_ID+1 },
+     { "reaches-file", OPT_REACHES_FILE, N_("FILE"), 0,
+       N_("Read pairs of symbols to check for reachability from FILE"),
+       GROUP_ID+1 },
+     { "path", OPT_PATH, N_("FROM:TO"), 0,
+       N_("Print the shortest call path from FROM to TO"), GROUP_ID+1 },
+     { "path-count", OPT_PATH_COUNT, N_("NUMBER"), 0,
+       N_("Print up to NUMBER shortest paths for each --path"), GROUP_ID+1 },
+     { "neighborhood", OPT_NEIGHBORHOOD, N_("NAME"), 0,
+       N_("Print the callees and callers of NAME within --radius calls"),
+       GROUP_ID+1 },
+     { "radius", OPT_RADIUS, N_("NUMBER"), 0,
+       N_("Set the radius of --neighborhood (default 1)"), GROUP_ID+1 },
+     { "edge-list", OPT_EDGE_LIST, NULL, 0,
+       N_("Print neighborhoods and aggregated graphs as lists of edges"), GROUP_ID+1 },
+     { "dominators", OPT_DOMINATORS, NULL, 0,
+       N_("Print the dominator tree of the start functions"), GROUP_ID+1 },
+     { "unreachable", OPT_UNREACHABLE, NULL, 0,
+       N_("List functions that cannot be reached from the start functions"),
+       GROUP_ID+1 },
+     { "impacted-by", OPT_IMPACTED_BY, N_("FILE"), 0,
+       N_("Read changed line ranges (FILE:START-END) from FILE and list the functions affected by the changes"),
+       GROUP_ID+1 },
+     { "aggregate", OPT_AGGREGATE, N_("file|dir[:DEPTH]"), 0,
+       N_("Print the call graph between source files or directories"),
+       GROUP_ID+1 },
+     { "reach-counts", OPT_REACH_COUNTS, NULL, 0,
+       N_("Print the number of functions reachable from each function and the number of functions reaching it, as a separate list rather than a column of the tree"),
+       GROUP_ID+1 },
+     { "reach-matrix", OPT_REACH_MATRIX, NULL, 0,
+       N_("For each function, list all functions it calls directly or indirectly"),
+       GROUP_ID+1 },
+     { "threads", OPT_THREADS, N_("NUMBER"), 0,
+       N_("Use NUMBER threads for --reach-counts and --reach-matrix (default: one per CPU)"),
+       GROUP_ID+1 },
+     { "graph-stats", OPT_GRAPH_STATS, NULL, 0,
+       N_("Print call graph statistics"), GROUP_ID+1 },
+     { "max-depth-report", OPT_MAX_DEPTH_REPORT, NULL, 0,
+       N_("Print the longest call chain depth of each function"),
+       GROUP_ID+1 },
+     { "stack-usage", OPT_STACK_USAGE, N_("FILE"), 0,
+       N_("Read function frame sizes from FILE (as created by gcc -fstack-usage) and print the stack usage bound of each function"),
+       GROUP_ID+1 },
 #undef GROUP_ID
 #define GROUP_ID 30                 
      { NULL, 0, NULL, 0,
@@ -177,34 +274,6 @@ struct option_type {
     int type;            /* data associated with the arg */
 };
 
-int debug;              /* debug level */
-char *outname = "-";    /* default output file name */
-int print_option = 0;   /* what to print. */
-int verbose;            /* be verbose on output */
-int use_indentation;    /* Rely on indentation,
-			 * i.e. suppose the function body
-                         * is necessarily surrounded by the curly braces
-			 * in the first column
-                         */
-int record_defines;     /* Record macro definitions */
-int strict_ansi;        /* Assume sources to be written in ANSI C */
-int print_line_numbers; /* Print line numbers */
-int print_levels;       /* Print level number near every branch */
-int print_as_tree;      /* Print as tree */
-int brief_listing;      /* Produce short listing */
-int reverse_tree;       /* Generate reverse tree */
-int max_depth;          /* The depth at which the flowgraph is cut off */
-int emacs_option;       /* Format and check for use with Emacs cflow-mode */ 
-int omit_arguments_option;    /* Omit arguments from function declaration string */
-int omit_symbol_names_option; /* Omit symbol name from symbol declaration string */
-
-#define SM_FUNCTIONS   0x0001
-#define SM_DATA        0x0002
-#define SM_STATIC      0x0004
-#define SM_UNDERSCORE  0x0008
-#define SM_TYPEDEF     0x0010
-#define SM_UNDEFINED   0x0020
-
 #define CHAR_TO_SM(c) ((c)=='x' ? SM_DATA : \
                         (c)=='_' ? SM_UNDERSCORE : \
                          (c)=='s' ? SM_STATIC : \
@@ -212,16 +281,7 @@ int omit_symbol_names_option; /* Omit symbol name from symbol declaration string
                            (c)=='u' ? SM_UNDEFINED : 0)
 #define SYMBOL_INCLUDE(c) (symbol_map |= CHAR_TO_SM(c))
 #define SYMBOL_EXCLUDE(c) (symbol_map &= ~CHAR_TO_SM(c))
-int symbol_map;  /* A bitmap of symbols included in the graph. */
-
-char *level_indent[] = { NULL, NULL };
-char *level_end[] = { "", "" };
-char *level_begin = "";
-
-int preprocess_option = 0; /* Do they want to preprocess sources? */
 
-char *start_name = "main"; /* Name of start symbol */
-int all_functions;  
 struct linked_list *arglist;        /* List of command line arguments */
 
 /* Given the option_type array and (possibly abbreviated) option argument
@@ -502,6 +562,92 @@ add_name(const char *name)
      linked_list_append(&arglist, (void*) name);
 }
 
+static void
+add_start_name(char *name)
+{
+     if (!start_list)
+	  start_name = name;
+     linked_list_append(&start_list, name);
+}
+
+static void
+roots_file_line(const char *file, int line, int wordc, char **wordv,
+		void *data)
+{
+     int i;
+
+     for (i = 0; i < wordc; i++)
+	  add_start_name(xstrdup(wordv[i]));
+}
+
+/* Parse the argument of --lines: START-END, START- or -END */
+static void
+parse_line_range(const char *arg)
+{
+     const char *s = arg;
+     char *p;
+     long n;
+
+     first_line = 1;
+     last_line = 0;
+     if (*s != '-') {
+	  n = strtol(s, &p, 10);
+	  if (p == s || n <= 0)
+	       error(EX_USAGE, 0, _("invalid line range: %s"), arg);
+	  first_line = n;
+	  s = p;
+     }
+     if (*s++ != '-')
+	  error(EX_USAGE, 0, _("invalid line range: %s"), arg);
+     if (*s) {
+	  n = strtol(s, &p, 10);
+	  if (*p || n < first_line)
+	       error(EX_USAGE, 0, _("invalid line range: %s"), arg);
+	  last_line = n;
+     }
+}
+
+/* Parse the argument of --max-output-lines or --max-output-bytes */
+static size_t
+parse_output_limit(const char *arg)
+{
+     char *p;
+     unsigned long n;
+
+     errno = 0;
+     n = strtoul(arg, &p, 10);
+     if (p == arg || *p || n == 0 || errno || !isdigit(*arg))
+	  error(EX_USAGE, 0, _("invalid output limit: %s"), arg);
+     return n;
+}
+
+/* Parse the argument of --aggregate */
+static void
+parse_aggregate(const char *arg)
+{
+     char *p;
+     long n;
+
+     if (strcmp(arg, "file") == 0) {
+	  aggregate_mode = AGGREGATE_FILE;
+	  return;
+     }
+     if (strncmp(arg, "dir", 3) == 0) {
+	  aggregate_mode = AGGREGATE_DIR;
+	  aggregate_depth = 0;
+	  if (arg[3] == 0)
+	       return;
+	  if (arg[3] == ':') {
+	       n = strtol(arg + 4, &p, 10);
+	       if (p > arg + 4 && *p == 0 && n > 0) {
+		    aggregate_depth = n;
+		    return;
+	       }
+	  }
+     }
+     error(EX_USAGE, 0, _("invalid aggregation mode: %s"), arg);
+}
+
 static void
 add_preproc_option(int key, const char *arg)
 {
@@ -615,6 +761,98 @@ parse_opt (int key, char *arg, struct argp_state *state)
      case OPT_NO_OMIT_SYMBOL_NAMES:
 	  omit_symbol_names_option = 0;
 	  break;
+     case OPT_CYCLES:
+	  print_cycles_option = 1;
+	  break;
+     case OPT_NO_CYCLES:
+	  print_cycles_option = 0;
+	  break;
+     case OPT_COMPRESS:
+	  compress_tree = 1;
+	  break;
+     case OPT_NO_COMPRESS:
+	  compress_tree = 0;
+	  break;
+     case OPT_LINES:
+	  parse_line_range(arg);
+	  break;
+     case OPT_MAX_OUTPUT_LINES:
+	  max_output_lines = parse_output_limit(arg);
+	  break;
+     case OPT_MAX_OUTPUT_BYTES:
+	  max_output_bytes = parse_output_limit(arg);
+	  break;
+     case OPT_REACHES:
+	  if (!strchr(arg, ':'))
+	       error(EX_USAGE, 0, _("%s: expected FROM:TO"), arg);
+	  linked_list_append(&reach_pairs, arg);
+	  print_option |= PRINT_REACH;
+	  break;
+     case OPT_PATH:
+	  if (!strchr(arg, ':'))
+	       error(EX_USAGE, 0, _("%s: expected FROM:TO"), arg);
+	  linked_list_append(&path_pairs, arg);
+	  print_option |= PRINT_PATH;
+	  break;
+     case OPT_PATH_COUNT:
+	  num = atoi(arg);
+	  if (num <= 0)
+	       error(EX_USAGE, 0, _("invalid path count: %s"), arg);
+	  path_count = num;
+	  break;
+     case OPT_NEIGHBORHOOD:
+	  linked_list_append(&neighborhood_names, arg);
+	  print_option |= PRINT_NEIGHBORHOOD;
+	  break;
+     case OPT_RADIUS:
+	  num = atoi(arg);
+	  if (num < 0 || !isdigit(*arg))
+	       error(EX_USAGE, 0, _("invalid radius: %s"), arg);
+	  neighborhood_radius = num;
+	  break;
+     case OPT_EDGE_LIST:
+	  edge_list = 1;
+	  break;
+     case OPT_DOMINATORS:
+	  print_option |= PRINT_DOMINATORS;
+	  break;
+     case OPT_UNREACHABLE:
+	  print_option |= PRINT_UNREACHABLE;
+	  break;
+     case OPT_IMPACTED_BY:
+	  linked_list_append(&impact_files, arg);
+	  print_option |= PRINT_IMPACT;
+	  break;
+     case OPT_AGGREGATE:
+	  parse_aggregate(arg);
+	  print_option |= PRINT_AGGREGATE;
+	  break;
+     case OPT_REACH_COUNTS:
+	  print_option |= PRINT_REACH_COUNTS;
+	  break;
+     case OPT_REACH_MATRIX:
+	  print_option |= PRINT_REACH_MATRIX;
+	  break;
+     case OPT_THREADS:
+	  num = atoi(arg);
+	  if (num <= 0)
+	       error(EX_USAGE, 0, _("invalid number of threads: %s"), arg);
+	  threads = num;
+	  break;
+     case OPT_GRAPH_STATS:
+	  print_option |= PRINT_STATS;
+	  break;
+     case OPT_MAX_DEPTH_REPORT:
+	  print_option |= PRINT_DEPTH;
+	  break;
+     case OPT_STACK_USAGE:
+	  linked_list_append(&stack_usage_files, arg);
+	  print_option |= PRINT_DEPTH;
+	  break;
+     case OPT_REACHES_FILE:
+	  linked_list_append(&reach_files, arg);
+	  print_option |= PRINT_REACH;
+	  break;
      case 'l':
 	  print_levels = 1;
 	  break;
@@ -622,10 +860,14 @@ parse_opt (int key, char *arg, struct argp_state *state)
 	  print_levels = 0;
 	  break;
      case 'm':
-	  start_name = strdup(arg);
+	  add_start_name(xstrdup(arg));
+	  break;
+     case OPT_ROOTS_FILE:
+	  read_word_file(arg, roots_file_line, NULL);
 	  break;
      case OPT_NO_MAIN:
 	  start_name = NULL;
+	  linked_list_destroy(&start_list);
 	  break;
      case 'n':
 	  print_line_numbers = 1;
@@ -636,6 +878,12 @@ parse_opt (int key, char *arg, struct argp_state *state)
      case 'o':
 	  outname = strdup(arg);
 	  break;
+     case 'j':
+	  num = atoi(arg);
+	  if (num <= 0)
+	       error(EX_USAGE, 0, _("invalid number of jobs: %s"), arg);
+	  jobs = num;
+	  break;
      case 'p':
 	  num = atoi(arg);
 	  if (num > 0)
@@ -667,6 +915,12 @@ parse_opt (int key, char *arg, struct argp_state *state)
      case OPT_NO_PREPROCESS:
 	  preprocess_option = 0;
 	  break;
+     case OPT_PREPROCESS_BATCH:
+	  num = atoi(arg);
+	  if (num <= 0)
+	       error(EX_USAGE, 0, _("invalid batch size: %s"), arg);
+	  pp_batch = num;
+	  break;
      case ARGP_KEY_ARG:
 	  add_name(arg);
 	  break;
@@ -691,66 +945,6 @@ static struct argp argp = {
      NULL
 };
 
-int
-globals_only()
-{
-     return !(symbol_map & SM_STATIC);
-}
-
-int
-include_symbol(Symbol *sym)
-{
-     int type = 0;
-     
-     if (!sym)
-	  return 0;
-     
-     if (sym->type == SymIdentifier) {
-	  if (sym->name[0] == '_' && !(symbol_map & SM_UNDERSCORE))
-	       return 0;
-
-	  if (sym->storage == StaticStorage)
-	       type |= SM_STATIC;
-	  if (sym->arity == -1 && sym->storage != AutoStorage)
-	       type |= SM_DATA;
-	  else if (sym->arity >= 0)
-	       type |= SM_FUNCTIONS;
-
-	  if (!sym->source)
-	       type |= SM_UNDEFINED;
-	  
-     } else if (sym->type == SymToken) {
-	  if (sym->token_type == TYPE && sym->source)
-	       type |= SM_TYPEDEF;
-	  else
-	       return 0;
-     }
-     return (symbol_map & type) == type;
-}
-
-void
-xalloc_die(void)
-{
-     error(EX_FATAL, ENOMEM, _("Exiting"));
-     abort();
-}
-
-void
-init()
-{
-     if (level_indent[0] == NULL) 
-	  level_indent[0] = "    "; /* 4 spaces */
-     if (level_indent[1] == NULL)
-	  level_indent[1] = level_indent[0];
-     if (level_end[0] == NULL)
-	  level_end[0] = "";
-     if (level_end[1] == NULL)
-	  level_end[1] = "";
-     
-     init_lex(debug > 2);
-     init_parse();
-}
-
 const char version_etc_copyright[] =
   /* Do *not* mark this string for translation.  %s is a copyright
      symbol suitable for this locale, and %d is the copyright
@@ -805,28 +999,40 @@ main(int argc, char **argv)
 	       }
 	       p = next;
 	  }
+     }
+     
+     argc -= index;
+     argv += index;
+
+     if (preprocess_option && pp_batch > 1)
+	  status = parse_batched(arglist, argc, argv);
+     else if (preprocess_option && jobs > 1)
+	  status = parse_parallel(arglist, argc, argv);
+     else {
+	  struct linked_list_entry *p;
+
 	  /* Second pass: collect sources */
 	  for (p = linked_list_head(arglist); p; p = p->next) {
 	       char *s = (char*)p->data;
 	       if (source(s) == 0)
 		    yyparse();
 	  }
-     }
-     
-     argc -= index;
-     argv += index;
-
-     while (argc--) {
-	  if (source(*argv++) == 0)
-	       yyparse();
-	  else
-	       status = EX_SOFT;
+	  while (argc--) {
+	       if (source(*argv++) == 0)
+		    yyparse();
+	       else
+		    status = EX_SOFT;
+	  }
      }
 
      if (input_file_count == 0)
 	     error(EX_USAGE, 0, _("no input files"));
 
+     if (print_option & PRINT_GRAPH)
+	  graph_freeze();
      output();
+     if (status == EX_OK)
+	  status = output_status;
      return status;
 }
 
@@ -26,6 +26,26 @@ int level_mark_incr = 128; /* level_mark is expanded by this number of bytes */
 
 int out_line = 1; /* Current output line number */
 FILE *outfile;    /* Output file */
+int output_status = EX_OK; /* EX_SOFT if some query could not be answered */
+
+#ifndef NULL_DEVICE
+# ifdef _WIN32
+#  define NULL_DEVICE "NUL"
+# else
+#  define NULL_DEVICE "/dev/null"
+# endif
+#endif
+
+static void update_window(void);
+static void finish_line(void);
+
+/* Report that the function NAME, given in a query, does not exist */
+void
+no_such_function(const char *name)
+{
+     error(0, 0, _("%s: no such function"), name);
+     output_status = EX_SOFT;
+}
 
 static void
 set_level_mark(int lev, int mark)
@@ -112,7 +132,9 @@ newline()
 					 outfile, out_line,
 					 NULL,
 				         output_driver[driver_index].handler_data);
+     finish_line();
      out_line++;
+     update_window();
 }
 
 static void
@@ -154,7 +176,8 @@ print_text(char *buf)
 #endif
 
 static int
-print_symbol (int direct, int level, int last, Symbol *sym)
+print_symbol_ext (int direct, int level, int last, Symbol *sym,
+		  size_t id, int ref, int leaf, size_t weight)
 {
      struct output_symbol output_symbol;
 
@@ -162,6 +185,10 @@ print_symbol (int direct, int level, int last, Symbol *sym)
      output_symbol.level = level;
      output_symbol.last = last;
      output_symbol.sym = sym;
+     output_symbol.id = id;
+     output_symbol.ref = ref;
+     output_symbol.leaf = leaf;
+     output_symbol.weight = weight;
 
      return output_driver[driver_index].handler(cflow_output_symbol,
 						outfile, out_line,
@@ -169,6 +196,13 @@ print_symbol (int direct, int level, int last, Symbol *sym)
 						output_driver[driver_index].handler_data);
 }
 
+static int
+print_symbol (int direct, int level, int last, Symbol *sym,
+	      size_t id, int ref)
+{
+     return print_symbol_ext(direct, level, last, sym, id, ref, 0, 0);
+}
+
 
 static int
 compare(const void *ap, const void *bp)
@@ -280,104 +314,709 @@ set_active(Symbol *sym)
 }
 
 static int
-is_printable(struct linked_list_entry *p)
+is_tree_node(Symbol *sym)
 {
-     return p != NULL && include_symbol((Symbol*)p->data);
+     return sym->type != SymUndefined && include_symbol(sym);
 }
 
 static int
-is_last(struct linked_list_entry *p)
+is_printable(size_t n)
+{
+     return include_symbol(call_graph.sym[n]);
+}
+
+/* Return the index of the last printable node in TAB, or N if there
+   is none */
+static size_t
+last_printable(size_t *tab, size_t n)
+{
+     size_t i = n;
+
+     while (i > 0)
+	  if (is_printable(tab[--i]))
+	       return i;
+     return n;
+}
+
+/* Compressed tree output.
+
+   With --compress, each subtree is expanded only once.  Every node that
+   has a subtree is labeled with a node ID, and its later occurrences
+   refer to that ID instead of repeating the subtree.  IDs are ranks of
+   the nodes in lexicographical order of the symbol names, so that they
+   don't depend on the order in which the tree is traversed. */
+
+int compress_tree;         /* --compress option */
+static size_t *node_id;    /* Node IDs, indexed by ord */
+
+static int
+compare_nodes(const void *ap, const void *bp)
+{
+     Symbol *a = call_graph.sym[*(size_t const *)ap];
+     Symbol *b = call_graph.sym[*(size_t const *)bp];
+     int rc = strcmp(a->name, b->name);
+
+     if (rc == 0) {
+	  rc = strcmp(a->source ? a->source : "", b->source ? b->source : "");
+	  if (rc == 0)
+	       rc = a->def_line - b->def_line;
+     }
+     return rc;
+}
+
+static void
+assign_node_ids()
+{
+     size_t *order, i;
+
+     if (node_id)
+	  return;
+     order = xcalloc(call_graph.nodes + 1, sizeof(order[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  order[i] = i;
+     qsort(order, call_graph.nodes, sizeof(order[0]), compare_nodes);
+     node_id = xcalloc(call_graph.nodes + 1, sizeof(node_id[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  node_id[order[i]] = i + 1;
+     free(order);
+}
+
+/* Return the ID of SYM, if the tree is compressed and SYM has a subtree
+   (HAS_SUBTREE is not 0), and 0 otherwise */
+static size_t
+subtree_id(Symbol *sym, int has_subtree)
+{
+     size_t n;
+
+     if (!compress_tree || !has_subtree
+	 || (n = graph_node(sym)) == GRAPH_NONE)
+	  return 0;
+     assign_node_ids();
+     return node_id[n];
+}
+
+/* Output limits.
+
+   With --lines, only lines first_line through last_line of the tree
+   output are printed.  The lines before the window are rendered to the
+   null device, so that line numbers and all references to them remain
+   the same as in the full output.  The traversal stops as soon as the
+   window is printed.
+
+   With --max-output-lines and --max-output-bytes, the tree output stops
+   when the budget is exhausted.  To check the byte budget, each line is
+   rendered to a temporary file first and copied to the output only if
+   it fits.  Once the budget is exhausted, the traversal stops, and the
+   lines and functions cut off are reported for each truncated tree.
+
+   The functions cut off are those reachable over the graph edges from
+   the nodes that were not printed, within the remaining depth, which
+   takes time linear in the size of the graph whatever the number of
+   paths.  The number of lines cut off is counted by count_tree, which
+   follows the paths of the tree, so it can be exponential in the size
+   of a graph with many cycles.  The whole output stops counting after
+   CUT_COUNT_MAX lines, and the counts reported after that are lower
+   bounds.
+
+   Whole subtrees that end before the window are skipped without being
+   visited, using their line counts.  The subtree of a non-recursive
+   function doesn't depend on the path that leads to it, only on its
+   level (if --depth is given), so its line count is computed once and
+   cached.  This is not so in --brief and --compress modes, where the
+   output depends on the subtrees printed before.  The output is linear
+   in the size of the graph in these modes, so the lines before the
+   window are simply rendered to the null device. */
+
+#define CUT_COUNT_MAX 1000000   /* Lines count_tree may visit after the
+				   budget is exhausted */
+
+int first_line;                 /* First line to print, 0 if no window */
+int last_line;                  /* Last line to print, 0 if unlimited */
+size_t max_output_lines;        /* Line budget, 0 if unlimited */
+size_t max_output_bytes;        /* Byte budget, 0 if unlimited */
+
+static int limit_output;        /* Any of the above is set */
+static FILE *real_outfile;      /* Output file for the printed lines */
+static FILE *null_outfile;      /* Output file for the rest */
+static FILE *line_outfile;      /* Temporary file for the current line */
+static size_t lines_used;       /* Lines printed so far */
+static size_t bytes_used;       /* Bytes printed so far */
+static int budget_exhausted;    /* No more output fits in the budget */
+static int line_shown;          /* The last line was printed */
+static int line_dropped;        /* The last line didn't fit in the budget */
+static size_t *subtree_lines;   /* Cached line counts, indexed by ord */
+static int *subtree_level;      /* Level+1 they were computed for */
+
+/* Accounting of the truncated part of the current tree */
+static unsigned tree_stamp;     /* Number of the current tree */
+static unsigned *shown_stamp;   /* Tree in which the node was printed */
+static unsigned *cut_stamp;     /* Tree in which the node was cut off */
+static int *cut_depth;          /* Levels of its subtree that were cut off,
+				   -1 if unlimited */
+static size_t *cut_nodes;       /* Nodes cut off from the current tree */
+static size_t cut_count;        /* Number of entries in cut_nodes */
+static size_t cut_lines;        /* Lines cut off from the current tree */
+static size_t count_left;       /* Lines count_tree may still visit */
+static int count_stopped;       /* count_tree ran out of lines to visit */
+static int count_capped;        /* cut_lines is a lower bound */
+static size_t *cut_queue;       /* Circular queue for cut_subtree */
+static char *cut_queued;        /* Node is in cut_queue */
+
+static int
+in_window()
+{
+     return out_line >= first_line && (!last_line || out_line <= last_line);
+}
+
+static int
+window_done()
+{
+     return last_line && out_line > last_line;
+}
+
+/* Select the output file for the current line */
+static void
+update_window()
+{
+     if (!limit_output)
+	  return;
+     if (!in_window() || budget_exhausted)
+	  outfile = null_outfile;
+     else if (max_output_bytes)
+	  outfile = line_outfile;
+     else
+	  outfile = real_outfile;
+}
+
+/* Finish output of the current line */
+static void
+finish_line()
+{
+     line_shown = line_dropped = 0;
+     if (!limit_output || !in_window())
+	  return;
+     if (budget_exhausted) {
+	  line_dropped = 1;
+	  return;
+     }
+     if (max_output_bytes) {
+	  char buf[BUFSIZ];
+	  size_t len = ftell(line_outfile), n;
+
+	  if (bytes_used + len > max_output_bytes) {
+	       budget_exhausted = line_dropped = 1;
+	  } else {
+	       bytes_used += len;
+	       fseek(line_outfile, 0, SEEK_SET);
+	       while (len > 0 && (n = fread(buf, 1,
+					   len < sizeof buf ? len : sizeof buf,
+					   line_outfile)) > 0) {
+		    fwrite(buf, 1, n, real_outfile);
+		    len -= n;
+	       }
+	  }
+	  fseek(line_outfile, 0, SEEK_SET);
+     }
+     if (line_dropped)
+	  return;
+     line_shown = 1;
+     if (max_output_lines && ++lines_used == max_output_lines)
+	  budget_exhausted = 1;
+}
+
+static FILE *
+open_null_device()
+{
+     FILE *fp = fopen(NULL_DEVICE, "w");
+     if (!fp)
+	  error(EX_FATAL, errno, _("cannot open file `%s'"), NULL_DEVICE);
+     return fp;
+}
+
+static void
+limits_begin()
+{
+     size_t n = call_graph.nodes + 1;
+
+     limit_output = first_line || max_output_lines || max_output_bytes;
+     if (!limit_output)
+	  return;
+     if (!first_line)
+	  first_line = 1;
+     real_outfile = outfile;
+     null_outfile = open_null_device();
+     if (max_output_bytes) {
+	  line_outfile = tmpfile();
+	  if (!line_outfile)
+	       error(EX_FATAL, errno, _("cannot create temporary file"));
+     }
+     if (max_output_lines || max_output_bytes) {
+	  shown_stamp = xcalloc(n, sizeof(shown_stamp[0]));
+	  cut_stamp = xcalloc(n, sizeof(cut_stamp[0]));
+	  cut_depth = xcalloc(n, sizeof(cut_depth[0]));
+	  cut_nodes = xcalloc(n, sizeof(cut_nodes[0]));
+	  cut_queue = xcalloc(n, sizeof(cut_queue[0]));
+	  cut_queued = xzalloc(n);
+	  count_left = CUT_COUNT_MAX;
+     }
+     update_window();
+}
+
+static void
+limits_end()
+{
+     if (!limit_output)
+	  return;
+     outfile = real_outfile;
+     fclose(null_outfile);
+     if (line_outfile)
+	  fclose(line_outfile);
+     free(subtree_lines);
+     free(subtree_level);
+     subtree_lines = NULL;
+     subtree_level = NULL;
+     free(shown_stamp);
+     free(cut_stamp);
+     free(cut_depth);
+     free(cut_nodes);
+     free(cut_queue);
+     free(cut_queued);
+}
+
+/* Return the number of lines print_tree would output for SYM at level
+   LEV, if it were not cut off by the output limits.  Active symbols are
+   marked the same way print_tree does, and so are the expanded ones in
+   --brief and --compress modes.  If LEFT is not NULL, at most *LEFT
+   lines are visited, and the count stops there. */
+static size_t
+count_tree(int direct, int lev, Symbol *sym, size_t *left)
 {
-     while ((p = p->next))
-	  if (is_printable(p))
+     size_t *tab, i, n, node, count;
+     int cache, expand = brief_listing || compress_tree;
+
+     if (!is_tree_node(sym) || (max_depth && lev >= max_depth))
+	  return 0;
+     node = graph_node(sym);
+     cache = !expand && node != GRAPH_NONE && !graph_node_recursive(node);
+     if (cache) {
+	  if (!subtree_lines) {
+	       subtree_lines = xcalloc(call_graph.nodes + 1,
+				       sizeof(subtree_lines[0]));
+	       subtree_level = xcalloc(call_graph.nodes + 1,
+				       sizeof(subtree_level[0]));
+	  }
+	  if (subtree_level[node]
+	      && (!max_depth || subtree_level[node] == lev + 1)) {
+	       count = subtree_lines[node];
+	       if (left)
+		    *left -= count < *left ? count : *left;
+	       return count;
+	  }
+     }
+     if (left) {
+	  if (*left == 0) {
+	       count_stopped = 1;
+	       return 0;
+	  }
+	  --*left;
+     }
+     if (sym->active)
+	  return 1;
+
+     n = graph_adjacent(direct ? &call_graph.callee : &call_graph.caller,
+			sym, &tab);
+     if (expand) {
+	  /* The tests of print_symbol and print_tree, respectively */
+	  int has_subtree = compress_tree ? last_printable(tab, n) < n
+	                                  : sym->callee != NULL;
+	  if (sym->expand_line && has_subtree)
+	       return 1;
+	  /* The subtree is printed in full only without --depth */
+	  if (has_subtree && (!compress_tree || !max_depth))
+	       sym->expand_line = -1;
+     }
+     count = 1;
+     sym->active = 1;
+     for (i = 0; i < n; i++)
+	  count += count_tree(direct, lev+1, call_graph.sym[tab[i]], left);
+     clear_active(sym);
+
+     if (cache && !(left && *left == 0)) {
+	  subtree_lines[node] = count;
+	  subtree_level[node] = lev + 1;
+     }
+     return count;
+}
+
+/* Mark node N as cut off from the current tree along with DEPTH levels
+   of its subtree (-1 meaning all of them).  Return false if it has
+   already been marked so. */
+static int
+mark_cut(size_t n, int depth)
+{
+     if (cut_stamp[n] == tree_stamp) {
+	  if (cut_depth[n] == -1 || (depth != -1 && cut_depth[n] >= depth))
 	       return 0;
+     } else {
+	  cut_stamp[n] = tree_stamp;
+	  cut_nodes[cut_count++] = n;
+     }
+     cut_depth[n] = depth;
      return 1;
 }
 
-/* Produce direct call tree output
- */
+/* Mark the functions in the subtree of node N at level LEV as cut off.
+   These are the functions reachable from it within the depth limit.
+   A node is processed again if it is reached with more levels left. */
 static void
-direct_tree(int lev, int last, Symbol *sym)
+cut_subtree(int direct, int lev, size_t n)
 {
-     struct linked_list_entry *p;
-     int rc;
-     
-     if (sym->type == SymUndefined
-	 || (max_depth && lev >= max_depth)
-	 || !include_symbol(sym))
+     struct graph_adjacency *adj = direct ? &call_graph.callee
+	                                  : &call_graph.caller;
+     size_t size = call_graph.nodes + 1, head = 0, tail = 0, i;
+
+     if (!mark_cut(n, max_depth ? max_depth - lev - 1 : -1))
 	  return;
+     cut_queue[tail++] = n;
+     cut_queued[n] = 1;
+     while (head != tail) {
+	  size_t v = cut_queue[head];
+	  int depth = cut_depth[v];
 
-     rc = print_symbol(1, lev, last, sym);
-     newline();
-     if (rc || sym->active)
+	  head = (head + 1) % size;
+	  cut_queued[v] = 0;
+	  if (depth == 0)
+	       continue;
+	  for (i = adj->off[v]; i < adj->off[v+1]; i++) {
+	       size_t w = adj->tab[i];
+	       if (is_tree_node(call_graph.sym[w])
+		   && mark_cut(w, depth == -1 ? -1 : depth - 1)
+		   && !cut_queued[w]) {
+		    cut_queue[tail] = w;
+		    tail = (tail + 1) % size;
+		    cut_queued[w] = 1;
+	       }
+	  }
+     }
+}
+
+/* Return true if the subtree of SYM at level LEV ends before the
+   window, and if so, advance out_line past it */
+static int
+skip_tree(int direct, int lev, Symbol *sym)
+{
+     size_t n, count;
+
+     if (!limit_output || out_line >= first_line
+	 || brief_listing || compress_tree
+	 || sym->active
+	 || (n = graph_node(sym)) == GRAPH_NONE || graph_node_recursive(n))
+	  return 0;
+     count = count_tree(direct, lev, sym, NULL);
+     if (out_line + count > first_line)
+	  return 0;
+     out_line += count;
+     update_window();
+     return 1;
+}
+
+/* Account for the subtree of SYM at level LEV, which is cut off by the
+   output budget, without traversing it */
+static void
+cut_tree(int direct, int lev, Symbol *sym)
+{
+     /* The line of SYM itself is counted in any case */
+     size_t n = graph_node(sym), count, left = count_left ? count_left : 1;
+     int window = 0;
+
+     /* Lines past the window would not be printed anyway */
+     if (last_line && (size_t) (last_line + 1 - out_line) < left) {
+	  left = last_line + 1 - out_line;
+	  window = 1;
+     }
+     count_stopped = 0;
+     count = count_tree(direct, lev, sym, &left);
+     count_left -= count < count_left ? count : count_left;
+     if (count_stopped && !window)
+	  count_capped = 1;
+     cut_lines += count;
+     out_line += count;
+     if (n != GRAPH_NONE)
+	  cut_subtree(direct, lev, n);
+}
+
+/* Record the output of SYM on the current line */
+static void
+account_line(Symbol *sym)
+{
+     size_t n;
+
+     if (!cut_stamp || (n = graph_node(sym)) == GRAPH_NONE)
 	  return;
+     if (line_dropped) {
+	  cut_lines++;
+	  mark_cut(n, 0);
+     } else if (line_shown)
+	  shown_stamp[n] = tree_stamp;
+}
+
+/* Produce call tree output.  DIRECT is 1 for the direct tree and 0
+ * for the reverse one.  Return 1 if any part of the subtree was cut
+ * off by --depth or by the output limits.
+ */
+static int
+print_tree(int direct, int lev, int last, Symbol *sym)
+{
+     size_t *tab, i, n, lasti, id;
+     int rc, ref, cut;
+     
+     if (!is_tree_node(sym))
+	  return 0;
+     if ((max_depth && lev >= max_depth) || window_done())
+	  return 1;
+     if (budget_exhausted) {
+	  cut_tree(direct, lev, sym);
+	  return 1;
+     }
+     if (skip_tree(direct, lev, sym))
+	  return 0;
+     n = graph_adjacent(direct ? &call_graph.callee : &call_graph.caller,
+			sym, &tab);
+     lasti = last_printable(tab, n);
+     id = subtree_id(sym, lasti < n);
+     ref = id && sym->expand_line && !sym->active;
+     rc = print_symbol(direct, lev, last, sym, id, ref);
+     newline();
+     account_line(sym);
+     cut = line_dropped;
+     if (rc || ref || sym->active)
+	  return cut;
      set_active(sym);
-     for (p = linked_list_head(sym->callee); p; p = p->next) {
-	  set_level_mark(lev+1, !is_last(p));
-	  direct_tree(lev+1, is_last(p), (Symbol*)p->data);
+     for (i = 0; i < n; i++) {
+	  int islast = i >= lasti;
+	  set_level_mark(lev+1, !islast);
+	  cut |= print_tree(direct, lev+1, islast, call_graph.sym[tab[i]]);
      }
      clear_active(sym);
+     /* Only a subtree printed in full can be referred to */
+     if (id && !cut)
+	  sym->expand_line = id;
+     return cut;
+}
+
+/* Print the tree of the root symbol SYM and report how much of it was
+   cut off by the output budget */
+static void
+print_root(int direct, Symbol *sym)
+{
+     size_t i, nfunc;
+
+     if (!cut_stamp) {
+	  print_tree(direct, 0, 0, sym);
+	  return;
+     }
+     tree_stamp++;
+     cut_count = cut_lines = 0;
+     count_capped = 0;
+     print_tree(direct, 0, 0, sym);
+     if (cut_lines == 0 && !count_capped)
+	  return;
+     for (i = nfunc = 0; i < cut_count; i++)
+	  if (shown_stamp[cut_nodes[i]] != tree_stamp)
+	       nfunc++;
+     if (count_capped)
+	  error(0, 0,
+		_("%s: output truncated: at least %lu lines omitted, "
+		  "%lu functions not shown"),
+		sym->name, (unsigned long) cut_lines, (unsigned long) nfunc);
+     else
+	  error(0, 0,
+		_("%s: output truncated: %lu lines omitted, "
+		  "%lu functions not shown"),
+		sym->name, (unsigned long) cut_lines, (unsigned long) nfunc);
+}
+
+/* Produce direct call tree output
+ */
+static void
+direct_tree(Symbol *sym)
+{
+     print_root(1, sym);
 }
 
 /* Produce reverse call tree output
  */
 static void
-inverted_tree(int lev, int last, Symbol *sym)
+inverted_tree(Symbol *sym)
+{
+     print_root(0, sym);
+}
+
+/* Clear the traversal state of the COUNT nodes listed in NODES */
+static void
+reset_traversal(size_t *nodes, size_t count)
+{
+     size_t i;
+
+     for (i = 0; i < count; i++) {
+	  Symbol *sym = call_graph.sym[nodes[i]];
+	  sym->active = 0;
+	  sym->expand_line = 0;
+     }
+}
+
+/* Print the call tree of the start symbol MAIN_SYM only.  Instead of
+   collecting and sorting the whole symbol table, find the symbols that
+   can appear in the output and mark recursive calls among them. */
+static void
+start_tree_output(Symbol *main_sym)
+{
+     size_t *nodes, num;
+
+     num = graph_reachable(&call_graph.callee, main_sym, max_depth,
+			   is_tree_node, &nodes);
+     graph_mark_recursive(nodes, num);
+     free(nodes);
+
+     begin();
+     direct_tree(main_sym);
+     separator();
+     end();
+}
+
+/* Print the call trees of all symbols from start_list.  Each tree is
+   printed as if it were the only one, i.e. --brief references don't
+   point to the trees printed before it.  Static functions of the same
+   name are printed in the order of their source files. */
+static void
+roots_tree_output()
 {
      struct linked_list_entry *p;
-     int rc;
-     
-     if (sym->type == SymUndefined
-	 || (max_depth && lev >= max_depth)
-	 || !include_symbol(sym))
-	  return;
-     rc = print_symbol(0, lev, last, sym);
-     newline();
-     if (rc || sym->active)
-	  return;
-     set_active(sym);
-     for (p = linked_list_head(sym->caller); p; p = p->next) {
-	  set_level_mark(lev+1, !is_last(p));
-	  inverted_tree(lev+1, is_last(p), (Symbol*)p->data);
+
+     for (p = linked_list_head(start_list); p; p = p->next) {
+	  size_t *targets, ntargets, i;
+
+	  ntargets = graph_find(p->data, &targets);
+	  if (ntargets == 0)
+	       no_such_function(p->data);
+	  qsort(targets, ntargets, sizeof(targets[0]), compare_nodes);
+	  for (i = 0; i < ntargets; i++) {
+	       Symbol *sym = call_graph.sym[targets[i]];
+	       size_t *nodes, num;
+	       
+	       num = graph_reachable(&call_graph.callee, sym, max_depth,
+				     is_tree_node, &nodes);
+	       direct_tree(sym);
+	       separator();
+	       reset_traversal(nodes, num);
+	       free(nodes);
+	  }
+	  free(targets);
      }
-     clear_active(sym);
+}
+
+/* Print the reverse trees of the symbols from start_list.  Only the
+   callers of these symbols are visited, the rest of the symbol table is
+   neither collected nor sorted. */
+static void
+targets_tree_output()
+{
+     struct linked_list_entry *p;
+     size_t *nodes, num = 0, i, j;
+     char *seen;
+
+     /* Collect the nodes that can appear in the trees */
+     nodes = xcalloc(call_graph.nodes + 1, sizeof(nodes[0]));
+     seen = xzalloc(call_graph.nodes + 1);
+     for (p = linked_list_head(start_list); p; p = p->next) {
+	  size_t *targets, ntargets;
+
+	  ntargets = graph_find(p->data, &targets);
+	  for (i = 0; i < ntargets; i++) {
+	       size_t *tab, n;
+
+	       n = graph_reachable(&call_graph.caller,
+				   call_graph.sym[targets[i]], max_depth,
+				   is_tree_node, &tab);
+	       for (j = 0; j < n; j++)
+		    if (!seen[tab[j]]) {
+			 seen[tab[j]] = 1;
+			 nodes[num++] = tab[j];
+		    }
+	       free(tab);
+	  }
+	  free(targets);
+     }
+     graph_mark_recursive(nodes, num);
+
+     begin();
+     for (p = linked_list_head(start_list); p; p = p->next) {
+	  size_t *targets, ntargets;
+
+	  ntargets = graph_find(p->data, &targets);
+	  if (ntargets == 0)
+	       no_such_function(p->data);
+	  /* Static functions of the same name are printed in the order
+	     of their source files */
+	  qsort(targets, ntargets, sizeof(targets[0]), compare_nodes);
+	  for (i = 0; i < ntargets; i++) {
+	       inverted_tree(call_graph.sym[targets[i]]);
+	       separator();
+	       reset_traversal(nodes, num);
+	  }
+	  free(targets);
+     }
+     end();
+
+     free(nodes);
+     free(seen);
+}
+
+/* Return true if SYM is one of the start symbols */
+static int
+is_start_symbol(Symbol *sym, Symbol *main_sym)
+{
+     struct linked_list_entry *p;
+
+     if (linked_list_size(start_list) <= 1)
+	  return sym == main_sym;
+     for (p = linked_list_head(start_list); p; p = p->next)
+	  if (strcmp(sym->name, p->data) == 0)
+	       return 1;
+     return 0;
 }
 
 static void
 tree_output()
 {
-     Symbol **symbols, *main_sym;
+     Symbol **symbols, *main_sym = NULL;
      size_t i, num;
-     cflow_depmap_t depmap;
-     
-     /* Collect functions and assign them ordinal numbers */
-     num = collect_functions(&symbols);
-     for (i = 0; i < num; i++)
-	  symbols[i]->ord = i;
-     
-     /* Create a dependency matrix */
-     depmap = depmap_alloc(num);
-     for (i = 0; i < num; i++) {
-	  if (symbols[i]->callee) {
-	       struct linked_list_entry *p;
-	       
-	       for (p = linked_list_head(symbols[i]->callee); p;
-		    p = p->next) {
-		    Symbol *s = (Symbol*) p->data;
-		    if (symbol_is_function(s))
-			 depmap_set(depmap, i, ((Symbol*)p->data)->ord);
-	       }		    
-	  }
+     int multiple_roots = linked_list_size(start_list) > 1;
+
+     if (!reverse_tree && !multiple_roots && start_name
+	 && (main_sym = lookup(start_name)) != NULL
+	 && !all_functions) {
+	  start_tree_output(main_sym);
+	  return;
      }
-     
-     depmap_tc(depmap);
 
+     if (reverse_tree && start_list && !all_functions) {
+	  targets_tree_output();
+	  return;
+     }
+     
      /* Mark recursive calls */
-     for (i = 0; i < num; i++)
-	  if (depmap_isset(depmap, i, i))
-	       symbols[i]->recursive = 1;
-     free(depmap);
-     free(symbols);
+     graph_mark_recursive(NULL, 0);
+
+     /* Start functions given explicitly are looked up among the static
+	ones as well, and reported if not found */
+     if (!reverse_tree && start_list && !all_functions
+	 && (multiple_roots || !main_sym)) {
+	  begin();
+	  roots_tree_output();
+	  end();
+	  return;
+     }
      
      /* Collect and sort all symbols */
      num = collect_symbols(&symbols, is_var, 0);
@@ -388,12 +1027,14 @@ tree_output()
     
      if (reverse_tree) {
 	  for (i = 0; i < num; i++) {
-	       inverted_tree(0, 0, symbols[i]);
+	       inverted_tree(symbols[i]);
 	       separator();
 	  }
      } else {
-	  if ((main_sym = start_name ? lookup(start_name) : NULL) != NULL) {
-	       direct_tree(0, 0, main_sym);
+	  if (multiple_roots) {
+	       roots_tree_output();
+	  } else if (main_sym) {
+	       direct_tree(main_sym);
 	       separator();
 	  } else if (!all_functions) {
 	       all_functions = 1;
@@ -401,10 +1042,10 @@ tree_output()
 
 	  if (all_functions) {
 	       for (i = 0; i < num; i++) {
-		    if (main_sym != symbols[i]
+		    if (!is_start_symbol(symbols[i], main_sym)
 			&& symbols[i]->source
 			&& (all_functions > 1 || symbols[i]->caller == NULL)) {
-			 direct_tree(0, 0, symbols[i]);
+			 direct_tree(symbols[i]);
 			 separator();
 		    }
 	       }
@@ -416,25 +1057,388 @@ tree_output()
      free(symbols);
 }
 
+
+/* Call path output */
+
+struct linked_list *path_pairs;  /* FROM:TO arguments of --path */
+size_t path_count = 1;           /* Number of paths to print for each */
+
+/* Find the nodes of the functions named NAME that can appear in the
+   call trees, in the order of their source files.  Store them in a
+   newly allocated array in *RETURN_NODES and return their number. */
+static size_t
+path_nodes(const char *name, size_t **return_nodes)
+{
+     size_t *nodes, num, i, count;
+
+     num = graph_find(name, &nodes);
+     for (i = count = 0; i < num; i++)
+	  if (is_tree_node(call_graph.sym[nodes[i]]))
+	       nodes[count++] = nodes[i];
+     if (count == 0)
+	  no_such_function(name);
+     qsort(nodes, count, sizeof(nodes[0]), compare_nodes);
+     *return_nodes = nodes;
+     return count;
+}
+
+static void
+print_path(struct call_path *path)
+{
+     size_t i;
+     
+     for (i = 0; i < path->len; i++) {
+	  Symbol *sym = call_graph.sym[path->nodes[i]];
+	  set_level_mark(i, 0);
+	  print_symbol_ext(1, i, 1, sym, 0, 0, i == path->len - 1, 0);
+	  newline();
+     }
+     separator();
+     reset_traversal(path->nodes, path->len);
+}
+
+/* Print the call paths for each FROM:TO pair.  If several static
+   functions have the same name, the paths between each pair of them
+   are printed. */
+static void
+path_output()
+{
+     struct linked_list_entry *p;
+
+     graph_mark_recursive(NULL, 0);
+     begin();
+     for (p = linked_list_head(path_pairs); p; p = p->next) {
+	  char *from = p->data;
+	  char *to = strchr(from, ':');
+	  size_t *a, *b, na, nb, i, j, k, n, total = 0;
+	  struct call_path *paths;
+	  
+	  *to++ = 0;
+	  na = path_nodes(from, &a);
+	  nb = path_nodes(to, &b);
+	  for (i = 0; i < na; i++)
+	       for (j = 0; j < nb; j++) {
+		    n = path_shortest(a[i], b[j], is_tree_node, path_count,
+				      &paths);
+		    for (k = 0; k < n; k++)
+			 print_path(&paths[k]);
+		    path_free(paths, n);
+		    total += n;
+	       }
+	  if (na && nb && total == 0) {
+	       error(0, 0, _("no call path from %s to %s"), from, to);
+	       output_status = EX_SOFT;
+	  }
+	  free(a);
+	  free(b);
+	  to[-1] = ':';
+     }
+     end();
+}
+
+
+/* Neighborhood output */
+
+struct linked_list *neighborhood_names; /* Arguments of --neighborhood */
+int neighborhood_radius = 1;            /* Argument of --radius */
+int edge_list;                          /* --edge-list option */
+
+/* Print the call edges between the COUNT nodes listed in NODES.  IN[N]
+   is nonzero if node N is one of them. */
+static void
+print_edges(size_t *nodes, size_t count, char *in)
+{
+     size_t *callees = xcalloc(count + 1, sizeof(callees[0]));
+     size_t i, j, n;
+
+     qsort(nodes, count, sizeof(nodes[0]), compare_nodes);
+     for (i = 0; i < count; i++) {
+	  size_t u = nodes[i];
+
+	  n = 0;
+	  for (j = call_graph.callee.off[u]; j < call_graph.callee.off[u+1];
+	       j++)
+	       if (in[call_graph.callee.tab[j]])
+		    callees[n++] = call_graph.callee.tab[j];
+	  qsort(callees, n, sizeof(callees[0]), compare_nodes);
+	  for (j = 0; j < n; j++)
+	       fprintf(outfile, "%s %s\n", call_graph.sym[u]->name,
+		       call_graph.sym[callees[j]]->name);
+     }
+     free(callees);
+}
+
+/* Print the neighborhood of the function SYM: the functions within
+   neighborhood_radius calls from it in either direction */
+static void
+print_neighborhood(Symbol *sym, size_t *nodes, char *in)
+{
+     size_t *tab, n, i, num = 0;
+     int dir, save_depth = max_depth;
+
+     /* Collect the callees and the callers */
+     for (dir = 0; dir < 2; dir++) {
+	  n = graph_reachable(dir ? &call_graph.caller : &call_graph.callee,
+			      sym, neighborhood_radius + 1, is_tree_node, &tab);
+	  for (i = 0; i < n; i++)
+	       if (!in[tab[i]]) {
+		    in[tab[i]] = 1;
+		    nodes[num++] = tab[i];
+	       }
+	  free(tab);
+     }
+
+     if (edge_list)
+	  print_edges(nodes, num, in);
+     else {
+	  if (!max_depth || max_depth > neighborhood_radius + 1)
+	       max_depth = neighborhood_radius + 1;
+	  direct_tree(sym);
+	  separator();
+	  reset_traversal(nodes, num);
+	  inverted_tree(sym);
+	  separator();
+	  reset_traversal(nodes, num);
+	  max_depth = save_depth;
+     }
+
+     for (i = 0; i < num; i++)
+	  in[nodes[i]] = 0;
+}
+
+static void
+neighborhood_output()
+{
+     struct linked_list_entry *p;
+     size_t *nodes = xcalloc(call_graph.nodes + 1, sizeof(nodes[0]));
+     char *in = xzalloc(call_graph.nodes + 1);
+
+     graph_mark_recursive(NULL, 0);
+     begin();
+     for (p = linked_list_head(neighborhood_names); p; p = p->next) {
+	  size_t *targets, ntargets, i;
+
+	  ntargets = graph_find(p->data, &targets);
+	  if (ntargets == 0)
+	       no_such_function(p->data);
+	  qsort(targets, ntargets, sizeof(targets[0]), compare_nodes);
+	  for (i = 0; i < ntargets; i++)
+	       if (is_tree_node(call_graph.sym[targets[i]]))
+		    print_neighborhood(call_graph.sym[targets[i]], nodes, in);
+	  free(targets);
+     }
+     end();
+     free(nodes);
+     free(in);
+}
+
+
+/* Dominator tree output */
+
+struct dominator_tree {
+     size_t *idom;                 /* Immediate dominators, indexed by ord */
+     struct graph_adjacency child; /* Children of each node */
+};
+
+static void
+print_dominated(struct dominator_tree *dt, int lev, int last, size_t n)
+{
+     size_t i, first, count;
+
+     if (max_depth && lev >= max_depth)
+	  return;
+     first = dt->child.off[n];
+     count = dt->child.off[n+1] - first;
+     if (max_depth && lev + 1 >= max_depth)
+	  count = 0;
+     /* The subtree marker depends on the dominated functions, not on
+	the callees */
+     print_symbol_ext(1, lev, last, call_graph.sym[n], 0, 0, count == 0, 0);
+     newline();
+     for (i = 0; i < count; i++) {
+	  set_level_mark(lev+1, i + 1 < count);
+	  print_dominated(dt, lev+1, i + 1 == count,
+			  dt->child.tab[first + i]);
+     }
+}
+
+/* Print the dominator tree of the function at node ROOT */
+static void
+dominator_tree(size_t root)
+{
+     struct dominator_tree dt;
+     size_t num, i, n;
+
+     num = graph_dominators(root, is_tree_node, &dt.idom);
+
+     /* Build the lists of children, sorted by name */
+     dt.child.off = xcalloc(call_graph.nodes + 1, sizeof(dt.child.off[0]));
+     dt.child.tab = xcalloc(num + 1, sizeof(dt.child.tab[0]));
+     for (i = 0; i < call_graph.nodes; i++)
+	  if (dt.idom[i] != GRAPH_NONE)
+	       dt.child.off[dt.idom[i]+1]++;
+     for (i = 0; i < call_graph.nodes; i++)
+	  dt.child.off[i+1] += dt.child.off[i];
+     for (i = 0; i < call_graph.nodes; i++)
+	  if ((n = dt.idom[i]) != GRAPH_NONE)
+	       dt.child.tab[dt.child.off[n]++] = i;
+     for (i = call_graph.nodes; i > 0; i--)
+	  dt.child.off[i] = dt.child.off[i-1];
+     dt.child.off[0] = 0;
+     for (i = 0; i < call_graph.nodes; i++)
+	  qsort(dt.child.tab + dt.child.off[i],
+		dt.child.off[i+1] - dt.child.off[i],
+		sizeof(dt.child.tab[0]), compare_nodes);
+
+     print_dominated(&dt, 0, 0, root);
+     separator();
+     for (i = 0; i < call_graph.nodes; i++)
+	  call_graph.sym[i]->expand_line = 0;
+
+     free(dt.idom);
+     free(dt.child.off);
+     free(dt.child.tab);
+}
+
+/* Print the dominator trees of the functions named NAME.  Static
+   functions of the same name are printed in the order of their source
+   files. */
+static void
+dominator_trees(const char *name)
+{
+     size_t *nodes, num, i;
+
+     num = path_nodes(name, &nodes);
+     for (i = 0; i < num; i++)
+	  dominator_tree(nodes[i]);
+     free(nodes);
+}
+
+/* Print the dominator trees of the start functions.  A function
+   dominates another one if every call chain leading from the start
+   function to the latter passes through the former. */
+static void
+dominator_output()
+{
+     struct linked_list_entry *p;
+
+     if (!start_name)
+	  error(EX_USAGE, 0, _("--dominators requires a start function"));
+     graph_mark_recursive(NULL, 0);
+     begin();
+     if (start_list) {
+	  for (p = linked_list_head(start_list); p; p = p->next)
+	       dominator_trees(p->data);
+     } else
+	  dominator_trees(start_name);
+     end();
+}
+
+
+/* Aggregated graph output */
+
+/* Print the graph between source files or directories as a tree of
+   depth 1: each group is followed by the groups it calls, along with
+   the number of calls. */
+static void
+aggregate_output()
+{
+     struct aggregate_graph ag;
+     size_t i, j, first, count;
+
+     if (edge_list) {
+	  aggregate_edge_output();
+	  return;
+     }
+     aggregate_graph(&ag);
+     begin();
+     for (i = 0; i < ag.ngroups; i++) {
+	  print_symbol(1, 0, 0, &ag.group[i], 0, 0);
+	  newline();
+	  if (max_depth == 1)
+	       continue;
+	  first = ag.edge.off[i];
+	  count = ag.edge.off[i+1] - first;
+	  for (j = 0; j < count; j++) {
+	       set_level_mark(1, j + 1 < count);
+	       print_symbol_ext(1, 1, j + 1 == count,
+				&ag.group[ag.edge.tab[first + j]], 0, 0, 1,
+				ag.weight[first + j]);
+	       newline();
+	  }
+     }
+     end();
+     aggregate_free(&ag);
+}
+
 void
 output()
 {
+     FILE *fp;
+     
      if (strcmp(outname, "-") == 0) {
-	  outfile = stdout;
+	  fp = stdout;
      } else {
-	  outfile = fopen(outname, "w");
-	  if (!outfile)
+	  fp = fopen(outname, "w");
+	  if (!fp)
 	       error(EX_FATAL, errno, _("cannot open file `%s'"), outname);
      } 
-     
+     output_stream(fp);
+     fclose(fp);
+}
+
+/* Write the requested output to FP */
+void
+output_stream(FILE *fp)
+{
+     outfile = fp;
+     out_line = 1;
+     output_status = EX_OK;
      set_level_mark(0, 0);
      if (print_option & PRINT_XREF) {
 	  xref_output();
      }
      if (print_option & PRINT_TREE) {
+	  limits_begin();
 	  tree_output();
+	  limits_end();
+     }
+     if (print_option & PRINT_REACH) {
+	  reach_output();
+     }
+     if (print_option & PRINT_PATH) {
+	  path_output();
+     }
+     if (print_option & PRINT_NEIGHBORHOOD) {
+	  neighborhood_output();
+     }
+     if (print_option & PRINT_DOMINATORS) {
+	  dominator_output();
+     }
+     if (print_option & PRINT_UNREACHABLE) {
+	  unreachable_output();
+     }
+     if (print_option & PRINT_IMPACT) {
+	  impact_output();
+     }
+     if (print_option & PRINT_AGGREGATE) {
+	  aggregate_output();
+     }
+     if (print_option & PRINT_REACH_COUNTS) {
+	  reach_counts_output();
+     }
+     if (print_option & PRINT_REACH_MATRIX) {
+	  reach_matrix_output();
+     }
+     if (print_option & PRINT_STATS) {
+	  stats_output();
+     }
+     if (print_option & PRINT_DEPTH) {
+	  depth_output();
      }
-     fclose(outfile);
+     /* Node IDs are only valid for the current graph */
+     free(node_id);
+     node_id = NULL;
 }
 
 
@@ -329,6 +329,18 @@ init_parse()
      clearstack();
 }
 
+/* Discard the declarations composed during the previous run */
+void
+reset_parse()
+{
+     obstack_free(&text_stk, NULL);
+     obstack_init(&text_stk);
+     clearstack();
+     level = 0;
+     parm_level = 0;
+     caller = NULL;
+}
+
 void
 save_token(TOKSTK *tokptr)
 {
@@ -1087,10 +1099,14 @@ func_body()
 	       if (verbose)
 		    file_error(_("unexpected end of file in function body"),
 			       NULL);
+	       if (caller)
+		    caller->end_line = line_num;
 	       caller = NULL;
 	       return;
 	  }
      }
+     if (caller)
+	  caller->end_line = tok.line;
      caller = NULL;
 }
 
@@ -1278,12 +1294,8 @@ call(char *name, int line)
 	  return;
      if (sp->arity < 0)
 	  sp->arity = 0;
-     if (caller) {
-	  if (!data_in_list(caller, sp->caller))
-	       linked_list_append(&sp->caller, caller);
-	  if (!data_in_list(sp, caller->callee))
-	       linked_list_append(&caller->callee, sp);
-     }
+     if (caller)
+	  add_edge(caller, sp);
 }
 
 void
@@ -1292,11 +1304,7 @@ reference(char *name, int line)
      Symbol *sp = add_reference(name, line);
      if (!sp)
 	  return;
-     if (caller) {
-	  if (!data_in_list(caller, sp->caller))
-	       linked_list_append(&sp->caller, caller);
-	  if (!data_in_list(sp, caller->callee))
-	       linked_list_append(&caller->callee, sp);
-     }
+     if (caller)
+	  add_edge(caller, sp);
 }
 
@@ -0,0 +1,293 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Shortest call paths.
+
+   A single shortest path is found by a bidirectional breadth-first
+   search: forward over the callee edges from the source, backward over
+   the caller edges from the target, always expanding one full level of
+   the smaller frontier.  The search stops at the end of the first level
+   in which the two searches meet.
+
+   The K shortest simple paths are enumerated using Yen's algorithm,
+   which runs the above search from each node of the last found path,
+   with the nodes preceding it and the edges already used by the
+   previously found paths removed from the graph. */
+
+struct search {
+     int (*sel)(Symbol *);         /* Node selector */
+     unsigned stamp;               /* Current search number */
+     unsigned *seen[2];            /* Last search that visited the node,
+				      in each direction */
+     size_t *dist[2];              /* Distance from the source or target */
+     size_t *parent[2];            /* Previous node on the search tree */
+     size_t *queue[2];             /* Level-ordered queues */
+     unsigned *banned;             /* Node is banned in the search with
+				      this number */
+     unsigned *banned_edge;        /* Edge from the spur node to this
+				      node is banned in the search */
+     size_t spur;                  /* Spur node */
+};
+
+static void
+search_init(struct search *s, int (*sel)(Symbol *))
+{
+     size_t n = call_graph.nodes + 1;
+     int i;
+
+     s->sel = sel;
+     s->stamp = 0;
+     for (i = 0; i < 2; i++) {
+	  s->seen[i] = xcalloc(n, sizeof(s->seen[i][0]));
+	  s->dist[i] = xcalloc(n, sizeof(s->dist[i][0]));
+	  s->parent[i] = xcalloc(n, sizeof(s->parent[i][0]));
+	  s->queue[i] = xcalloc(n, sizeof(s->queue[i][0]));
+     }
+     s->banned = xcalloc(n, sizeof(s->banned[0]));
+     s->banned_edge = xcalloc(n, sizeof(s->banned_edge[0]));
+     s->spur = GRAPH_NONE;
+}
+
+static void
+search_free(struct search *s)
+{
+     int i;
+
+     for (i = 0; i < 2; i++) {
+	  free(s->seen[i]);
+	  free(s->dist[i]);
+	  free(s->parent[i]);
+	  free(s->queue[i]);
+     }
+     free(s->banned);
+     free(s->banned_edge);
+}
+
+/* Return true if node V can be used in the current search */
+static int
+node_ok(struct search *s, size_t v)
+{
+     return s->banned[v] != s->stamp && s->sel(call_graph.sym[v]);
+}
+
+/* Return true if the edge U->V (in the direction of calls) is removed
+   from the graph for the current search */
+static int
+edge_banned(struct search *s, size_t u, size_t v)
+{
+     return u == s->spur && s->banned_edge[v] == s->stamp;
+}
+
+/* Find a shortest path from FROM to TO.  Return its length in nodes
+   and store it in a newly allocated array in *RETURN_PATH.  Return 0
+   if there is no path.  Bans set up for the current stamp apply. */
+static size_t
+search_path(struct search *s, size_t from, size_t to, size_t **return_path)
+{
+     size_t head[2], tail[2], level_end[2];
+     size_t best = GRAPH_NONE, meet = GRAPH_NONE;
+     size_t *path, len, pos, v;
+     int dir;
+
+     *return_path = NULL;
+     if (s->banned[from] == s->stamp || s->banned[to] == s->stamp)
+	  return 0;
+     for (dir = 0; dir < 2; dir++) {
+	  size_t n = dir ? to : from;
+	  s->seen[dir][n] = s->stamp;
+	  s->dist[dir][n] = 0;
+	  s->parent[dir][n] = GRAPH_NONE;
+	  s->queue[dir][0] = n;
+	  head[dir] = 0;
+	  tail[dir] = level_end[dir] = 1;
+     }
+
+     if (from == to)
+	  meet = from;
+
+     while (meet == GRAPH_NONE && head[0] < tail[0] && head[1] < tail[1]) {
+	  struct graph_adjacency *adj;
+
+	  /* Expand the smaller frontier */
+	  dir = (tail[0] - head[0]) > (tail[1] - head[1]);
+	  adj = dir ? &call_graph.caller : &call_graph.callee;
+	  level_end[dir] = tail[dir];
+	  while (head[dir] < level_end[dir]) {
+	       size_t u = s->queue[dir][head[dir]++];
+	       size_t i;
+
+	       for (i = adj->off[u]; i < adj->off[u+1]; i++) {
+		    size_t w = adj->tab[i];
+
+		    if (!node_ok(s, w)
+			|| (dir ? edge_banned(s, w, u) : edge_banned(s, u, w)))
+			 continue;
+		    if (s->seen[!dir][w] == s->stamp) {
+			 size_t d = s->dist[dir][u] + 1 + s->dist[!dir][w];
+			 if (best == GRAPH_NONE || d < best) {
+			      best = d;
+			      meet = w;
+			      /* Make the meeting point reachable from
+				 this side too */
+			      if (s->seen[dir][w] != s->stamp
+				  || s->dist[dir][w] > s->dist[dir][u] + 1) {
+				   s->seen[dir][w] = s->stamp;
+				   s->dist[dir][w] = s->dist[dir][u] + 1;
+				   s->parent[dir][w] = u;
+			      }
+			 }
+		    }
+		    if (s->seen[dir][w] != s->stamp) {
+			 s->seen[dir][w] = s->stamp;
+			 s->dist[dir][w] = s->dist[dir][u] + 1;
+			 s->parent[dir][w] = u;
+			 s->queue[dir][tail[dir]++] = w;
+		    }
+	       }
+	  }
+     }
+
+     if (meet == GRAPH_NONE)
+	  return 0;
+
+     len = s->dist[0][meet] + s->dist[1][meet] + 1;
+     path = xcalloc(len, sizeof(path[0]));
+     pos = s->dist[0][meet];
+     for (v = meet; v != GRAPH_NONE; v = s->parent[0][v])
+	  path[pos--] = v;
+     pos = s->dist[0][meet] + 1;
+     for (v = s->parent[1][meet]; v != GRAPH_NONE; v = s->parent[1][v])
+	  path[pos++] = v;
+     *return_path = path;
+     return len;
+}
+
+static int
+path_eq(struct call_path *p, size_t *nodes, size_t len)
+{
+     return p->len == len
+	  && memcmp(p->nodes, nodes, len * sizeof(nodes[0])) == 0;
+}
+
+static int
+path_known(struct call_path *tab, size_t n, size_t *nodes, size_t len)
+{
+     size_t i;
+
+     for (i = 0; i < n; i++)
+	  if (path_eq(&tab[i], nodes, len))
+	       return 1;
+     return 0;
+}
+
+/* Find up to K shortest simple paths from node FROM to node TO,
+   traversing only nodes whose symbols satisfy SEL.  Paths are returned
+   in order of increasing length in a newly allocated array in
+   *RETURN_PATHS.  Return the number of paths found. */
+size_t
+path_shortest(size_t from, size_t to, int (*sel)(Symbol *), size_t k,
+	      struct call_path **return_paths)
+{
+     struct search s;
+     struct call_path *found, *cand = NULL;
+     size_t nfound = 0, ncand = 0, maxcand = 0;
+     size_t *nodes, len;
+
+     found = xcalloc(k + 1, sizeof(found[0]));
+     *return_paths = found;
+     if (k == 0)
+	  return 0;
+
+     search_init(&s, sel);
+     s.stamp++;
+     len = search_path(&s, from, to, &nodes);
+     if (len) {
+	  found[0].nodes = nodes;
+	  found[0].len = len;
+	  nfound = 1;
+     }
+
+     while (nfound > 0 && nfound < k) {
+	  struct call_path *last = &found[nfound-1];
+	  size_t i, j, best;
+
+	  for (i = 0; i + 1 < last->len; i++) {
+	       size_t *spur_path, spur_len;
+
+	       s.stamp++;
+	       s.spur = last->nodes[i];
+	       /* Remove the root path nodes */
+	       for (j = 0; j < i; j++)
+		    s.banned[last->nodes[j]] = s.stamp;
+	       /* Remove the edges used by the found paths with the same
+		  root path */
+	       for (j = 0; j < nfound; j++)
+		    if (found[j].len > i + 1
+			&& memcmp(found[j].nodes, last->nodes,
+				  (i + 1) * sizeof(size_t)) == 0)
+			 s.banned_edge[found[j].nodes[i+1]] = s.stamp;
+
+	       spur_len = search_path(&s, s.spur, to, &spur_path);
+	       if (spur_len == 0)
+		    continue;
+	       len = i + spur_len;
+	       nodes = xcalloc(len, sizeof(nodes[0]));
+	       memcpy(nodes, last->nodes, i * sizeof(nodes[0]));
+	       memcpy(nodes + i, spur_path, spur_len * sizeof(nodes[0]));
+	       free(spur_path);
+	       if (path_known(cand, ncand, nodes, len)
+		   || path_known(found, nfound, nodes, len)) {
+		    free(nodes);
+		    continue;
+	       }
+	       if (ncand == maxcand)
+		    cand = x2nrealloc(cand, &maxcand, sizeof(cand[0]));
+	       cand[ncand].nodes = nodes;
+	       cand[ncand].len = len;
+	       ncand++;
+	  }
+	  s.spur = GRAPH_NONE;
+
+	  if (ncand == 0)
+	       break;
+	  /* Pick the shortest candidate, the earliest one among equals */
+	  for (best = 0, i = 1; i < ncand; i++)
+	       if (cand[i].len < cand[best].len)
+		    best = i;
+	  found[nfound++] = cand[best];
+	  memmove(cand + best, cand + best + 1,
+		  (ncand - best - 1) * sizeof(cand[0]));
+	  ncand--;
+     }
+
+     while (ncand)
+	  free(cand[--ncand].nodes);
+     free(cand);
+     search_free(&s);
+     return nfound;
+}
+
+void
+path_free(struct call_path *paths, size_t n)
+{
+     size_t i;
+
+     for (i = 0; i < n; i++)
+	  free(paths[i].nodes);
+     free(paths);
+}
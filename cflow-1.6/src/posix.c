@@ -29,20 +29,35 @@ print_symbol_type(FILE *outfile, Symbol *sym)
 	  fprintf(outfile, "<>");
 }
 
+static void
+print_weight(FILE *outfile, struct output_symbol *s)
+{
+     if (s->weight)
+	  fprintf(outfile, " [weight %lu]", (unsigned long) s->weight);
+}
+
 static int
 print_symbol(FILE *outfile, int line, struct output_symbol *s)
 {
      print_level(s->level, s->last);
      fprintf(outfile, "%s: ", s->sym->name);
-     
-     if (brief_listing) {
+
+     if (s->ref) {
+	  fprintf(outfile, "#%lu", (unsigned long) s->id);
+	  return 1;
+     }
+     if (brief_listing && !compress_tree) {
 	  if (s->sym->expand_line) {
 	       fprintf(outfile, "%d", s->sym->expand_line);
+	       print_weight(outfile, s);
 	       return 1;
-	  } else if (s->sym->callee)
+	  } else if (s->sym->callee && !s->leaf)
 	       s->sym->expand_line = line;
      }
      print_symbol_type(outfile, s->sym);
+     if (s->id)
+	  fprintf(outfile, " #%lu", (unsigned long) s->id);
+     print_weight(outfile, s);
      return 0;
 }
 
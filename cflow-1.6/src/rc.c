@@ -140,3 +140,58 @@ sourcerc(int *argc_ptr, char ***argv_ptr)
 
 
 	
+
+/* Read the file NAME line by line.  Split each line into words and
+ * call FUN for each non-empty one.  Everything from `#' to the end of
+ * line is a comment.  If NAME is "-", read from the standard input.
+ */
+void
+read_word_file(const char *name, word_file_fp fun, void *data)
+{
+     FILE *fp;
+     char *buf = NULL;
+     size_t size = 0, len;
+     struct wordsplit ws;
+     int wsflags;
+     int line;
+
+     if (strcmp(name, "-") == 0)
+	  fp = stdin;
+     else {
+	  fp = fopen(name, "r");
+	  if (!fp)
+	       error(EX_FATAL, errno, _("cannot open `%s'"), name);
+     }
+
+     ws.ws_comment = "#";
+     wsflags = WRDSF_DEFFLAGS | WRDSF_COMMENT;
+     line = 0;
+     for (;;) {
+	  /* Read next line */
+	  len = 0;
+	  do {
+	       if (size - len < 2)
+		    buf = x2realloc(buf, &size);
+	       if (!fgets(buf + len, size - len, fp))
+		    break;
+	       len += strlen(buf + len);
+	  } while (buf[len-1] != '\n');
+	  if (len == 0)
+	       break;
+	  ++line;
+	  
+	  if (wordsplit(buf, &ws, wsflags))
+	       error(EX_FATAL, 0, "%s:%d: %s",
+		     name, line, wordsplit_strerror(&ws));
+	  wsflags |= WRDSF_REUSE;
+	  if (ws.ws_wordc)
+	       fun(name, line, ws.ws_wordc, ws.ws_wordv, data);
+     }
+     if (ferror(fp))
+	  error(EX_FATAL, errno, _("error reading `%s'"), name);
+     if (wsflags & WRDSF_REUSE)
+	  wordsplit_free(&ws);
+     free(buf);
+     if (fp != stdin)
+	  fclose(fp);
+}
@@ -0,0 +1,577 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Reachability index.
+
+   Queries are answered on the condensation of the call graph (see
+   graph_condense).  Two nodes of the same component reach each other.
+   Components are numbered in reverse topological order, so component A
+   cannot reach component B if A < B.  The remaining queries are
+   answered using 2-hop labels, computed by pruned landmark labeling:
+
+   Components are ranked by decreasing (in-degree+1)*(out-degree+1).
+   For each component V, in rank order, a forward BFS adds V to the
+   "in" label of each component it reaches, and a backward BFS adds it
+   to the "out" label of each component reaching it.  The search is
+   pruned at components for which the labels computed so far already
+   answer the query.  Then A reaches B if and only if out(A) and in(B)
+   have a common element.  Labels are built in rank order, so they are
+   kept sorted and intersection is a simple merge.
+
+   For call graphs labels are usually a few entries long, so the index
+   stays linear in the graph size, as opposed to the quadratic
+   dependency map. */
+
+struct label {
+     size_t *tab;                  /* Ranks of the landmarks */
+     size_t count;                 /* Number of used entries */
+     size_t size;                  /* Number of allocated entries */
+};
+
+static struct label *label_in, *label_out;
+
+static void
+label_add(struct label *lab, size_t rank)
+{
+     if (lab->count == lab->size)
+	  lab->tab = x2nrealloc(lab->tab, &lab->size, sizeof(lab->tab[0]));
+     lab->tab[lab->count++] = rank;
+}
+
+static int
+label_intersect(struct label *a, struct label *b)
+{
+     size_t i = 0, j = 0;
+
+     while (i < a->count && j < b->count) {
+	  if (a->tab[i] == b->tab[j])
+	       return 1;
+	  if (a->tab[i] < b->tab[j])
+	       i++;
+	  else
+	       j++;
+     }
+     return 0;
+}
+
+static size_t *rank_degree;
+
+static int
+rank_compare(const void *a, const void *b)
+{
+     size_t x = *(size_t const *)a;
+     size_t y = *(size_t const *)b;
+
+     if (rank_degree[x] > rank_degree[y])
+	  return -1;
+     if (rank_degree[x] < rank_degree[y])
+	  return 1;
+     return x < y ? -1 : x > y;
+}
+
+/* Pruned BFS over ADJ from component ROOT of rank RANK.  FWD is
+   nonzero for the forward search. */
+static void
+label_bfs(struct graph_adjacency *adj, size_t root, size_t rank, int fwd,
+	  size_t *queue, size_t *visited)
+{
+     size_t head = 0, tail = 0, i;
+
+     queue[tail++] = root;
+     visited[root] = rank + 1;
+     while (head < tail) {
+	  size_t c = queue[head++];
+
+	  if (fwd) {
+	       if (label_intersect(&label_out[root], &label_in[c]))
+		    continue;
+	       label_add(&label_in[c], rank);
+	  } else {
+	       if (label_intersect(&label_out[c], &label_in[root]))
+		    continue;
+	       label_add(&label_out[c], rank);
+	  }
+
+	  for (i = adj->off[c]; i < adj->off[c+1]; i++) {
+	       size_t d = adj->tab[i];
+	       if (visited[d] != rank + 1) {
+		    visited[d] = rank + 1;
+		    queue[tail++] = d;
+	       }
+	  }
+     }
+}
+
+void
+reach_index_build()
+{
+     size_t nscc, i;
+     size_t *order, *queue, *visited;
+
+     if (label_in)
+	  return;
+     graph_condense();
+     nscc = call_graph.nscc;
+
+     rank_degree = xcalloc(nscc + 1, sizeof(rank_degree[0]));
+     order = xcalloc(nscc + 1, sizeof(order[0]));
+     for (i = 0; i < nscc; i++) {
+	  rank_degree[i] =
+	       (call_graph.scc_callee.off[i+1] - call_graph.scc_callee.off[i]
+		+ 1)
+	       * (call_graph.scc_caller.off[i+1] - call_graph.scc_caller.off[i]
+		  + 1);
+	  order[i] = i;
+     }
+     qsort(order, nscc, sizeof(order[0]), rank_compare);
+     free(rank_degree);
+     rank_degree = NULL;
+
+     label_in = xcalloc(nscc + 1, sizeof(label_in[0]));
+     label_out = xcalloc(nscc + 1, sizeof(label_out[0]));
+     queue = xcalloc(nscc + 1, sizeof(queue[0]));
+     visited = xcalloc(nscc + 1, sizeof(visited[0]));
+
+     for (i = 0; i < nscc; i++) {
+	  label_bfs(&call_graph.scc_callee, order[i], i, 1, queue, visited);
+	  label_bfs(&call_graph.scc_caller, order[i], i, 0, queue, visited);
+     }
+
+     free(order);
+     free(queue);
+     free(visited);
+}
+
+/* Free the reachability index.  It must be called before the
+   condensation of the graph is freed. */
+void
+reach_index_free()
+{
+     size_t i;
+
+     if (!label_in)
+	  return;
+     for (i = 0; i < call_graph.nscc; i++) {
+	  free(label_in[i].tab);
+	  free(label_out[i].tab);
+     }
+     free(label_in);
+     free(label_out);
+     label_in = label_out = NULL;
+}
+
+/* Return true if node TO is reachable from node FROM */
+int
+reach_query(size_t from, size_t to)
+{
+     size_t a = call_graph.scc[from];
+     size_t b = call_graph.scc[to];
+
+     if (a == b)
+	  return 1;
+     if (a < b)
+	  return 0;
+     return label_intersect(&label_out[a], &label_in[b]);
+}
+
+
+/* Output */
+
+struct linked_list *reach_pairs;    /* FROM:TO arguments of --reaches */
+struct linked_list *reach_files;    /* Arguments of --reaches-file */
+
+/* Print the answer to the query FROM:TO.  Both names are looked up
+   among the static functions as well; if several functions have the
+   same name, TO is reachable if any of its functions is reachable from
+   any of the functions named FROM. */
+static void
+reach_print(const char *from, const char *to)
+{
+     size_t *a, *b, na, nb, i, j;
+     int found = 0;
+
+     na = graph_find(from, &a);
+     nb = graph_find(to, &b);
+     if (na == 0)
+	  no_such_function(from);
+     if (nb == 0)
+	  no_such_function(to);
+     if (na && nb) {
+	  for (i = 0; i < na && !found; i++)
+	       for (j = 0; j < nb && !found; j++)
+		    found = reach_query(a[i], b[j]);
+	  fprintf(outfile, "%s %s %s\n", from, to, found ? "yes" : "no");
+     }
+     free(a);
+     free(b);
+}
+
+static void
+reach_file_line(const char *file, int line, int wordc, char **wordv,
+		void *data)
+{
+     if (wordc != 2) {
+	  error(0, 0, _("%s:%d: expected two symbol names"), file, line);
+	  return;
+     }
+     reach_print(wordv[0], wordv[1]);
+}
+
+void
+reach_output()
+{
+     struct linked_list_entry *p;
+
+     reach_index_build();
+     for (p = linked_list_head(reach_pairs); p; p = p->next) {
+	  char *from = p->data;
+	  char *to = strchr(from, ':');
+
+	  *to = 0;
+	  reach_print(from, to + 1);
+	  *to = ':';
+     }
+     for (p = linked_list_head(reach_files); p; p = p->next)
+	  read_word_file(p->data, reach_file_line, NULL);
+}
+
+
+/* Unreachable functions */
+
+static int
+compare_symbols(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     int rc = strcmp((*sa)->name, (*sb)->name);
+     if (rc == 0)
+	  rc = strcmp((*sa)->source, (*sb)->source);
+     return rc;
+}
+
+/* Add the nodes of the start symbols named NAME to QUEUE, unless they
+   are already there.  Return the new queue length. */
+static size_t
+add_root(const char *name, size_t *queue, size_t tail, char *seen)
+{
+     size_t *nodes, num, i;
+
+     num = graph_find(name, &nodes);
+     if (num == 0)
+	  no_such_function(name);
+     for (i = 0; i < num; i++)
+	  if (!seen[nodes[i]]) {
+	       seen[nodes[i]] = 1;
+	       queue[tail++] = nodes[i];
+	  }
+     free(nodes);
+     return tail;
+}
+
+/* List the functions defined in the program that cannot be reached
+   from any of the start functions. */
+void
+unreachable_output()
+{
+     size_t *queue, head = 0, tail = 0, i, num;
+     char *seen;
+     Symbol **symbols;
+
+     if (!start_name)
+	  error(EX_USAGE, 0, _("--unreachable requires a start function"));
+     
+     queue = xcalloc(call_graph.nodes + 1, sizeof(queue[0]));
+     seen = xzalloc(call_graph.nodes + 1);
+
+     if (start_list) {
+	  struct linked_list_entry *p;
+	  for (p = linked_list_head(start_list); p; p = p->next)
+	       tail = add_root(p->data, queue, tail, seen);
+     } else
+	  tail = add_root(start_name, queue, tail, seen);
+
+     while (head < tail) {
+	  size_t v = queue[head++];
+	  for (i = call_graph.callee.off[v]; i < call_graph.callee.off[v+1];
+	       i++) {
+	       size_t w = call_graph.callee.tab[i];
+	       if (!seen[w]) {
+		    seen[w] = 1;
+		    queue[tail++] = w;
+	       }
+	  }
+     }
+
+     symbols = xcalloc(call_graph.nfunctions + 1, sizeof(symbols[0]));
+     for (i = num = 0; i < call_graph.nfunctions; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  if (!seen[i] && sym->source && include_symbol(sym))
+	       symbols[num++] = sym;
+     }
+     qsort(symbols, num, sizeof(symbols[0]), compare_symbols);
+     for (i = 0; i < num; i++)
+	  fprintf(outfile, "%s %s:%d\n",
+		  symbols[i]->name, symbols[i]->source, symbols[i]->def_line);
+     
+     free(symbols);
+     free(queue);
+     free(seen);
+}
+
+
+/* Change impact */
+
+struct linked_list *impact_files;   /* Arguments of --impacted-by */
+
+struct source_funcs {
+     char *source;                 /* Source file name */
+     Symbol **funcs;               /* Functions defined in it, sorted by
+				      line */
+     size_t count;
+};
+
+static struct source_funcs *sources;
+static size_t nsources;
+static char *impacted;             /* Impacted nodes */
+static size_t *impact_queue;
+static size_t impact_tail;
+
+static int
+compare_locations(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     int rc = strcmp((*sa)->source, (*sb)->source);
+     if (rc == 0)
+	  rc = (*sa)->def_line - (*sb)->def_line;
+     return rc;
+}
+
+/* Group the functions with known bodies by their source files */
+static void
+index_sources(Symbol **symbols)
+{
+     size_t i, num;
+
+     for (i = num = 0; i < call_graph.nfunctions; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  if (sym->source && sym->end_line > 0)
+	       symbols[num++] = sym;
+     }
+     qsort(symbols, num, sizeof(symbols[0]), compare_locations);
+
+     sources = xcalloc(num + 1, sizeof(sources[0]));
+     for (i = 0; i < num; i++) {
+	  if (nsources == 0
+	      || strcmp(sources[nsources-1].source, symbols[i]->source)) {
+	       sources[nsources].source = symbols[i]->source;
+	       sources[nsources].funcs = symbols + i;
+	       nsources++;
+	  }
+	  sources[nsources-1].count++;
+     }
+}
+
+/* Return true if NAME and SOURCE refer to the same file, i.e. one of
+   them is equal to the other or is its suffix beginning a path
+   component.  This allows for the names in diffs to be relative to a
+   different directory than the ones given in the command line. */
+static int
+same_file(const char *name, const char *source)
+{
+     size_t nlen = strlen(name), slen = strlen(source);
+
+     while (strncmp(name, "./", 2) == 0) {
+	  name += 2;
+	  nlen -= 2;
+     }
+     if (nlen == slen)
+	  return strcmp(name, source) == 0;
+     if (nlen < slen)
+	  return source[slen - nlen - 1] == '/'
+	         && strcmp(source + slen - nlen, name) == 0;
+     return name[nlen - slen - 1] == '/'
+	    && strcmp(name + nlen - slen, source) == 0;
+}
+
+static void
+add_impacted(Symbol *sym)
+{
+     size_t n = sym->ord;
+
+     if (!impacted[n]) {
+	  impacted[n] = 1;
+	  impact_queue[impact_tail++] = n;
+     }
+}
+
+/* Mark the functions of SRC whose bodies intersect lines START..END */
+static void
+impact_hunk(struct source_funcs *src, int start, int end)
+{
+     size_t lo = 0, hi = src->count;
+
+     /* Function bodies don't overlap, so they are sorted by their last
+	lines as well.  Find the first one that ends at START or later. */
+     while (lo < hi) {
+	  size_t i = (lo + hi) / 2;
+	  if (src->funcs[i]->end_line < start)
+	       lo = i + 1;
+	  else
+	       hi = i;
+     }
+     for (; lo < src->count && src->funcs[lo]->def_line <= end; lo++)
+	  add_impacted(src->funcs[lo]);
+}
+
+/* Process a line of a hunk file.  Each word is of the form
+   FILE:START-END or FILE:LINE. */
+static void
+impact_file_line(const char *file, int line, int wordc, char **wordv,
+		 void *data)
+{
+     int i;
+
+     for (i = 0; i < wordc; i++) {
+	  char *p = strrchr(wordv[i], ':');
+	  char *q;
+	  long start, end;
+	  size_t j;
+
+	  if (!p) {
+	       error(0, 0, _("%s:%d: expected FILE:START-END"), file, line);
+	       continue;
+	  }
+	  start = end = strtol(p + 1, &q, 10);
+	  if (*q == '-')
+	       end = strtol(q + 1, &q, 10);
+	  if (q == p + 1 || *q || start <= 0 || end < start) {
+	       error(0, 0, _("%s:%d: invalid line range: %s"),
+		     file, line, p + 1);
+	       continue;
+	  }
+	  *p = 0;
+	  for (j = 0; j < nsources; j++)
+	       if (same_file(wordv[i], sources[j].source))
+		    impact_hunk(&sources[j], start, end);
+	  *p = ':';
+     }
+}
+
+/* List the functions affected by the changes listed in impact_files:
+   the functions whose bodies contain the changed lines, and all their
+   direct and indirect callers. */
+void
+impact_output()
+{
+     struct linked_list_entry *p;
+     Symbol **symbols;
+     size_t head = 0, i, num;
+
+     symbols = xcalloc(call_graph.nfunctions + 1, sizeof(symbols[0]));
+     index_sources(symbols);
+     impacted = xzalloc(call_graph.nodes + 1);
+     impact_queue = xcalloc(call_graph.nodes + 1, sizeof(impact_queue[0]));
+     for (p = linked_list_head(impact_files); p; p = p->next)
+	  read_word_file(p->data, impact_file_line, NULL);
+     free(sources);
+     sources = NULL;
+     nsources = 0;
+
+     while (head < impact_tail) {
+	  size_t v = impact_queue[head++];
+	  for (i = call_graph.caller.off[v]; i < call_graph.caller.off[v+1];
+	       i++)
+	       add_impacted(call_graph.sym[call_graph.caller.tab[i]]);
+     }
+
+     for (i = num = 0; i < call_graph.nfunctions; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  if (impacted[i] && sym->source && include_symbol(sym))
+	       symbols[num++] = sym;
+     }
+     qsort(symbols, num, sizeof(symbols[0]), compare_symbols);
+     for (i = 0; i < num; i++)
+	  fprintf(outfile, "%s %s:%d\n",
+		  symbols[i]->name, symbols[i]->source, symbols[i]->def_line);
+
+     free(symbols);
+     free(impacted);
+     free(impact_queue);
+}
+
+
+/* Reachability matrix */
+
+static int
+compare_nodes(const void *a, const void *b)
+{
+     Symbol *sa = call_graph.sym[*(size_t const *)a];
+     Symbol *sb = call_graph.sym[*(size_t const *)b];
+     int rc = strcmp(sa->name, sb->name);
+     if (rc == 0) {
+	  if (!sa->source || !sb->source)
+	       rc = (sa->source != NULL) - (sb->source != NULL);
+	  else
+	       rc = strcmp(sa->source, sb->source);
+     }
+     return rc;
+}
+
+/* For each function defined in the program, list the functions it
+   calls directly or indirectly.  These are the rows of the transitive
+   closure of the call graph, computed by depmap_tc, so the time and
+   memory needed are quadratic in the number of functions. */
+void
+reach_matrix_output()
+{
+     size_t n = call_graph.nfunctions, i, j, k, count;
+     size_t *nodes;
+     cflow_depmap_t dmap = depmap_alloc(n);
+
+     for (i = 0; i < n; i++)
+	  for (j = call_graph.callee.off[i]; j < call_graph.callee.off[i+1];
+	       j++)
+	       if (call_graph.callee.tab[j] < n)
+		    depmap_set(dmap, i, call_graph.callee.tab[j]);
+     depmap_tc(dmap, thread_count());
+
+     /* Rows and columns cover the selected functions only */
+     nodes = xcalloc(n + 1, sizeof(nodes[0]));
+     for (i = count = 0; i < n; i++)
+	  if (include_symbol(call_graph.sym[i]))
+	       nodes[count++] = i;
+     qsort(nodes, count, sizeof(nodes[0]), compare_nodes);
+     for (i = 0; i < count; i++) {
+	  size_t row = nodes[i];
+	  Symbol *sym = call_graph.sym[row];
+
+	  if (!sym->source)
+	       continue;
+	  fprintf(outfile, "%s:", sym->name);
+	  for (j = 0; j < count; j++) {
+	       k = nodes[j];
+	       if (depmap_isset(dmap, row, k))
+		    fprintf(outfile, " %s", call_graph.sym[k]->name);
+	  }
+	  fputc('\n', outfile);
+     }
+
+     free(nodes);
+     free(dmap);
+}
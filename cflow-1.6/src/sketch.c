@@ -0,0 +1,443 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/* Transitive reach counts.
+
+   For each function, the number of distinct functions reachable from
+   it by one or more calls, and the number of functions from which it
+   can be reached, are estimated without computing the transitive
+   closure.  Each component of the condensation (see graph_condense)
+   gets a sketch of the set of functions it reaches, including its own
+   members.  The sketch of a component is the union of its members and
+   the sketches of the components it calls, so the sketches are built
+   in reverse topological order.  Components of the same level (length
+   of the longest chain of components below them) don't depend on each
+   other, and are processed in parallel.  A sketch is freed as soon as
+   all components that use it are done.
+
+   A sketch is a sorted list of 64-bit hashes of its members as long
+   as it has at most SKETCH_SPARSE_MAX of them, so small counts are
+   exact.  Larger sets are kept as HyperLogLog registers, which give
+   an estimate with the relative standard error of about 1.6%.  Both
+   forms are functions of the set only, so the results don't depend on
+   the number of threads or the order of merges.  An estimate never
+   exceeds the sum of the sizes of the merged sets, nor the number of
+   functions that can be counted at all, which makes it exact on trees
+   and keeps it plausible on small graphs. */
+
+#define SKETCH_BITS 12                  /* Index bits of a hash */
+#define SKETCH_REGS (1 << SKETCH_BITS)  /* Number of registers */
+#define SKETCH_SPARSE_MAX 512           /* Max. size of the sparse form */
+
+struct sketch {
+     size_t count;                 /* Number of hashes in the sparse form */
+     uint64_t *hash;               /* Sorted hashes, NULL if dense */
+     unsigned char *reg;           /* Registers, NULL if sparse */
+     size_t bound;                 /* Upper bound of the set size */
+};
+
+static uint64_t
+node_hash(size_t n)
+{
+     /* SplitMix64 finalizer */
+     uint64_t z = (uint64_t) n + 0x9e3779b97f4a7c15ULL;
+     z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+     return z ^ (z >> 31);
+}
+
+static int
+compare_hash(const void *a, const void *b)
+{
+     uint64_t x = *(uint64_t const *)a;
+     uint64_t y = *(uint64_t const *)b;
+     return x < y ? -1 : x > y;
+}
+
+static void
+register_add(unsigned char *reg, uint64_t h)
+{
+     uint64_t w = h << SKETCH_BITS;
+     unsigned char rank = 1;
+
+     while (rank <= 64 - SKETCH_BITS && !(w & 0x8000000000000000ULL)) {
+	  w <<= 1;
+	  rank++;
+     }
+     if (reg[h >> (64 - SKETCH_BITS)] < rank)
+	  reg[h >> (64 - SKETCH_BITS)] = rank;
+}
+
+/* Convert sketch S to the dense form */
+static void
+sketch_densify(struct sketch *s)
+{
+     size_t i;
+
+     s->reg = xzalloc(SKETCH_REGS);
+     for (i = 0; i < s->count; i++)
+	  register_add(s->reg, s->hash[i]);
+     free(s->hash);
+     s->hash = NULL;
+     s->count = 0;
+}
+
+/* Add the set of sketch SRC to that of DST */
+static void
+sketch_merge(struct sketch *dst, struct sketch *src)
+{
+     size_t i, j, n;
+     uint64_t *tab;
+
+     if (src->reg) {
+	  if (!dst->reg)
+	       sketch_densify(dst);
+	  for (i = 0; i < SKETCH_REGS; i++)
+	       if (dst->reg[i] < src->reg[i])
+		    dst->reg[i] = src->reg[i];
+	  return;
+     }
+     if (dst->reg) {
+	  for (i = 0; i < src->count; i++)
+	       register_add(dst->reg, src->hash[i]);
+	  return;
+     }
+     if (src->count == 0)
+	  return;
+
+     tab = xcalloc(dst->count + src->count, sizeof(tab[0]));
+     for (i = j = n = 0; i < dst->count || j < src->count; ) {
+	  if (j == src->count
+	      || (i < dst->count && dst->hash[i] < src->hash[j]))
+	       tab[n++] = dst->hash[i++];
+	  else if (i == dst->count || src->hash[j] < dst->hash[i])
+	       tab[n++] = src->hash[j++];
+	  else {
+	       tab[n++] = dst->hash[i++];
+	       j++;
+	  }
+     }
+     free(dst->hash);
+     dst->hash = tab;
+     dst->count = n;
+     if (n > SKETCH_SPARSE_MAX)
+	  sketch_densify(dst);
+}
+
+/* Natural logarithm of X >= 1.  Avoids linking with the math library */
+static double
+natural_log(double x)
+{
+     double y, y2, term, sum = 0;
+     int k = 0, i;
+
+     while (x >= 2) {
+	  x /= 2;
+	  k++;
+     }
+     /* ln(x) = 2 atanh((x-1)/(x+1)) */
+     y = (x - 1) / (x + 1);
+     y2 = y * y;
+     term = y;
+     for (i = 1; i < 40; i += 2) {
+	  sum += term / i;
+	  term *= y2;
+     }
+     return 2 * sum + k * 0.69314718055994530942;
+}
+
+static size_t
+sketch_estimate(struct sketch *s)
+{
+     double m = SKETCH_REGS, sum = 0, est;
+     size_t i, zeros = 0;
+
+     if (!s->reg)
+	  return s->count;
+     for (i = 0; i < SKETCH_REGS; i++) {
+	  sum += 1.0 / (double) ((uint64_t) 1 << s->reg[i]);
+	  if (s->reg[i] == 0)
+	       zeros++;
+     }
+     est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+     /* Use linear counting for small cardinalities */
+     if (est <= 2.5 * m && zeros)
+	  est = m * natural_log(m / zeros);
+     return (size_t) (est + 0.5);
+}
+
+static void
+sketch_free(struct sketch *s)
+{
+     free(s->hash);
+     free(s->reg);
+     s->hash = NULL;
+     s->reg = NULL;
+     s->count = 0;
+}
+
+
+struct count_state {
+     struct graph_adjacency *adj;  /* Condensation edges to follow */
+     struct sketch *sketch;        /* Sketches, indexed by component */
+     size_t *pending;              /* Number of components still to use
+				      the sketch */
+     size_t *count;                /* Resulting counts */
+     size_t total;                 /* Number of functions counted */
+     size_t *order;                /* Components, ordered by level */
+     size_t *level_off;            /* Offsets of levels in order */
+     size_t nlevels;               /* Number of levels */
+     unsigned nthreads;            /* Number of threads */
+     /* Barrier */
+     pthread_mutex_t mutex;
+     pthread_cond_t cond;
+     unsigned waiting;             /* Number of threads waiting on it */
+     unsigned long generation;     /* Incremented each time it opens */
+};
+
+struct count_thread {
+     struct count_state *state;
+     pthread_t tid;
+     unsigned index;               /* Thread number */
+};
+
+static void
+count_barrier(struct count_state *st)
+{
+     pthread_mutex_lock(&st->mutex);
+     if (++st->waiting == st->nthreads) {
+	  st->waiting = 0;
+	  st->generation++;
+	  pthread_cond_broadcast(&st->cond);
+     } else {
+	  unsigned long gen = st->generation;
+	  while (gen == st->generation)
+	       pthread_cond_wait(&st->cond, &st->mutex);
+     }
+     pthread_mutex_unlock(&st->mutex);
+}
+
+/* Build the sketch of component C and compute its count */
+static void
+count_component(struct count_state *st, size_t c)
+{
+     struct sketch *s = &st->sketch[c];
+     size_t i, own = 0;
+     int cyclic = call_graph.scc_size[c] > 1;
+
+     s->hash = xcalloc(call_graph.scc_size[c], sizeof(s->hash[0]));
+     for (i = call_graph.scc_nodes.off[c];
+	  i < call_graph.scc_nodes.off[c+1]; i++) {
+	  size_t n = call_graph.scc_nodes.tab[i];
+	  if (include_symbol(call_graph.sym[n]))
+	       s->hash[own++] = node_hash(n);
+	  if (!cyclic)
+	       cyclic = graph_node_recursive(n);
+     }
+     s->count = own;
+     qsort(s->hash, own, sizeof(s->hash[0]), compare_hash);
+     if (own > SKETCH_SPARSE_MAX)
+	  sketch_densify(s);
+
+     s->bound = own;
+     for (i = st->adj->off[c]; i < st->adj->off[c+1]; i++) {
+	  sketch_merge(s, &st->sketch[st->adj->tab[i]]);
+	  s->bound += st->sketch[st->adj->tab[i]].bound;
+     }
+     if (s->bound > st->total)
+	  s->bound = st->total;
+
+     st->count[c] = sketch_estimate(s);
+     if (st->count[c] > s->bound)
+	  st->count[c] = s->bound;
+     /* A function reaches itself only through a cycle */
+     if (!cyclic)
+	  st->count[c] = st->count[c] > own ? st->count[c] - own : 0;
+}
+
+/* Free the sketches that are no longer needed after level L is done */
+static void
+count_release(struct count_state *st, size_t l)
+{
+     size_t i, j;
+
+     for (i = st->level_off[l]; i < st->level_off[l+1]; i++) {
+	  size_t c = st->order[i];
+
+	  for (j = st->adj->off[c]; j < st->adj->off[c+1]; j++) {
+	       size_t d = st->adj->tab[j];
+	       if (--st->pending[d] == 0)
+		    sketch_free(&st->sketch[d]);
+	  }
+	  if (st->pending[c] == 0)
+	       sketch_free(&st->sketch[c]);
+     }
+}
+
+static void *
+count_thread(void *data)
+{
+     struct count_thread *thr = data;
+     struct count_state *st = thr->state;
+     size_t l, i;
+
+     for (l = 0; l < st->nlevels; l++) {
+	  for (i = st->level_off[l] + thr->index; i < st->level_off[l+1];
+	       i += st->nthreads)
+	       count_component(st, st->order[i]);
+	  count_barrier(st);
+	  if (thr->index == 0)
+	       count_release(st, l);
+	  count_barrier(st);
+     }
+     return NULL;
+}
+
+static unsigned
+count_threads(size_t nscc)
+{
+     long n = thread_count();
+
+     /* Small graphs are not worth the synchronization */
+     if (n > nscc / 256)
+	  n = nscc / 256;
+     return n > 1 ? n : 1;
+}
+
+/* Compute the reach counts of all components over the condensation
+   edges ADJ.  REV is the adjacency in the opposite direction.  Store
+   the counts in COUNT. */
+static void
+reach_counts(struct graph_adjacency *adj, struct graph_adjacency *rev,
+	     int forward, size_t *count)
+{
+     size_t nscc = call_graph.nscc, c, i, l;
+     size_t *level;
+     struct count_state st;
+     struct count_thread *thr;
+     int rc;
+
+     /* Compute the levels.  Callees have lower component numbers than
+	their callers. */
+     level = xcalloc(nscc + 1, sizeof(level[0]));
+     st.nlevels = 0;
+     for (i = 0; i < nscc; i++) {
+	  c = forward ? i : nscc - 1 - i;
+	  for (l = adj->off[c]; l < adj->off[c+1]; l++)
+	       if (level[adj->tab[l]] + 1 > level[c])
+		    level[c] = level[adj->tab[l]] + 1;
+	  if (level[c] + 1 > st.nlevels)
+	       st.nlevels = level[c] + 1;
+     }
+     st.level_off = xcalloc(st.nlevels + 1, sizeof(st.level_off[0]));
+     for (c = 0; c < nscc; c++)
+	  st.level_off[level[c]+1]++;
+     for (l = 0; l < st.nlevels; l++)
+	  st.level_off[l+1] += st.level_off[l];
+     st.order = xcalloc(nscc + 1, sizeof(st.order[0]));
+     for (c = 0; c < nscc; c++)
+	  st.order[st.level_off[level[c]]++] = c;
+     for (l = st.nlevels; l > 0; l--)
+	  st.level_off[l] = st.level_off[l-1];
+     st.level_off[0] = 0;
+     free(level);
+
+     st.adj = adj;
+     st.count = count;
+     st.total = 0;
+     for (i = 0; i < call_graph.nodes; i++)
+	  if (include_symbol(call_graph.sym[i]))
+	       st.total++;
+     st.sketch = xcalloc(nscc + 1, sizeof(st.sketch[0]));
+     st.pending = xcalloc(nscc + 1, sizeof(st.pending[0]));
+     for (c = 0; c < nscc; c++)
+	  st.pending[c] = rev->off[c+1] - rev->off[c];
+     st.nthreads = count_threads(nscc);
+     st.waiting = 0;
+     st.generation = 0;
+     pthread_mutex_init(&st.mutex, NULL);
+     pthread_cond_init(&st.cond, NULL);
+
+     thr = xcalloc(st.nthreads, sizeof(thr[0]));
+     for (i = 0; i < st.nthreads; i++) {
+	  thr[i].state = &st;
+	  thr[i].index = i;
+     }
+     for (i = 1; i < st.nthreads; i++)
+	  if ((rc = pthread_create(&thr[i].tid, NULL, count_thread, &thr[i])))
+	       error(EX_FATAL, rc, _("cannot create thread"));
+     count_thread(&thr[0]);
+     for (i = 1; i < st.nthreads; i++)
+	  pthread_join(thr[i].tid, NULL);
+
+     pthread_mutex_destroy(&st.mutex);
+     pthread_cond_destroy(&st.cond);
+     free(thr);
+     free(st.sketch);
+     free(st.pending);
+     free(st.order);
+     free(st.level_off);
+}
+
+static int
+compare_symbols(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     int rc = strcmp((*sa)->name, (*sb)->name);
+     if (rc == 0)
+	  rc = strcmp((*sa)->source, (*sb)->source);
+     return rc;
+}
+
+/* Print the number of functions reachable from each function and the
+   number of functions reaching it */
+void
+reach_counts_output()
+{
+     size_t nfunc = call_graph.nfunctions, i, num;
+     size_t *reaches, *reached;
+     Symbol **symbols;
+
+     graph_condense();
+     reaches = xcalloc(call_graph.nscc + 1, sizeof(reaches[0]));
+     reached = xcalloc(call_graph.nscc + 1, sizeof(reached[0]));
+     reach_counts(&call_graph.scc_callee, &call_graph.scc_caller, 1,
+		  reaches);
+     reach_counts(&call_graph.scc_caller, &call_graph.scc_callee, 0,
+		  reached);
+
+     symbols = xcalloc(nfunc + 1, sizeof(symbols[0]));
+     for (i = num = 0; i < nfunc; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  if (sym->source && include_symbol(sym))
+	       symbols[num++] = sym;
+     }
+     qsort(symbols, num, sizeof(symbols[0]), compare_symbols);
+     for (i = 0; i < num; i++) {
+	  size_t c = call_graph.scc[symbols[i]->ord];
+	  fprintf(outfile, "%s %lu %lu\n", symbols[i]->name,
+		  (unsigned long) reaches[c], (unsigned long) reached[c]);
+     }
+
+     free(symbols);
+     free(reaches);
+     free(reached);
+}
@@ -0,0 +1,210 @@
+/* This file is part of GNU cflow
+   Copyright (C) 2026 Sergey Poznyakoff
+
+   GNU cflow is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   GNU cflow is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+
+#include <cflow.h>
+
+/* Call graph statistics.
+
+   All numbers are gathered in a single pass over the adjacency lists
+   of the frozen call graph.  Only the functions defined in the program
+   are described; calls to undefined functions count in the out-degrees
+   of their callers.  Histograms use power-of-two buckets: 0, 1, 2-3,
+   4-7 and so on.  Each line of the report has the form
+
+     KEY VALUE...
+
+   so that it can be easily processed by other programs. */
+
+#define STATS_BUCKETS (sizeof(size_t) * 8 + 1)
+#define STATS_TOP 10               /* Number of top fan-in functions */
+
+static size_t *in_degree;          /* Indexed by node */
+static size_t *out_degree;
+
+static size_t
+bucket(size_t n)
+{
+     size_t b = 0;
+
+     while (n) {
+	  n >>= 1;
+	  b++;
+     }
+     return b;
+}
+
+static void
+print_histogram(const char *key, size_t *hist)
+{
+     size_t b;
+
+     for (b = 0; b < STATS_BUCKETS; b++) {
+	  if (!hist[b])
+	       continue;
+	  if (b <= 1)
+	       fprintf(outfile, "%s %lu %lu\n", key, (unsigned long) b,
+		       (unsigned long) hist[b]);
+	  else
+	       fprintf(outfile, "%s %lu-%lu %lu\n", key,
+		       (unsigned long) 1 << (b - 1),
+		       ((unsigned long) 1 << b) - 1,
+		       (unsigned long) hist[b]);
+     }
+}
+
+static int
+is_counted(size_t n)
+{
+     Symbol *sym = call_graph.sym[n];
+     return sym->source && include_symbol(sym);
+}
+
+/* Return true if node A goes before node B in the fan-in list */
+static int
+fan_in_before(size_t a, size_t b)
+{
+     int rc;
+
+     if (in_degree[a] != in_degree[b])
+	  return in_degree[a] > in_degree[b];
+     rc = strcmp(call_graph.sym[a]->name, call_graph.sym[b]->name);
+     if (rc == 0)
+	  rc = strcmp(call_graph.sym[a]->source, call_graph.sym[b]->source);
+     return rc < 0;
+}
+
+static int
+compare_symbols(const void *a, const void *b)
+{
+     Symbol * const *sa = a;
+     Symbol * const *sb = b;
+     int rc = strcmp((*sa)->name, (*sb)->name);
+     if (rc == 0)
+	  rc = strcmp((*sa)->source, (*sb)->source);
+     return rc;
+}
+
+void
+stats_output()
+{
+     size_t nfunc = call_graph.nfunctions;
+     size_t in_hist[STATS_BUCKETS], out_hist[STATS_BUCKETS],
+	  scc_hist[STATS_BUCKETS];
+     size_t top[STATS_TOP], ntop = 0;
+     size_t *scc_count;
+     char *scc_cyclic;
+     size_t functions = 0, undefined = 0, calls = 0, roots = 0, leaves = 0,
+	  recursive = 0, components = 0, cycles = 0, largest = 0;
+     size_t i, j, num;
+     Symbol **symbols;
+
+     graph_scc();
+     memset(in_hist, 0, sizeof(in_hist));
+     memset(out_hist, 0, sizeof(out_hist));
+     memset(scc_hist, 0, sizeof(scc_hist));
+     in_degree = xcalloc(call_graph.nodes + 1, sizeof(in_degree[0]));
+     out_degree = xcalloc(call_graph.nodes + 1, sizeof(out_degree[0]));
+     scc_count = xcalloc(call_graph.nscc + 1, sizeof(scc_count[0]));
+     scc_cyclic = xzalloc(call_graph.nscc + 1);
+     symbols = xcalloc(nfunc + 1, sizeof(symbols[0]));
+
+     for (i = num = 0; i < nfunc; i++) {
+	  Symbol *sym = call_graph.sym[i];
+	  size_t c;
+
+	  if (!include_symbol(sym))
+	       continue;
+	  if (!sym->source) {
+	       undefined++;
+	       continue;
+	  }
+
+	  for (j = call_graph.callee.off[i]; j < call_graph.callee.off[i+1];
+	       j++)
+	       if (include_symbol(call_graph.sym[call_graph.callee.tab[j]]))
+		    out_degree[i]++;
+	  for (j = call_graph.caller.off[i]; j < call_graph.caller.off[i+1];
+	       j++)
+	       if (is_counted(call_graph.caller.tab[j]))
+		    in_degree[i]++;
+
+	  functions++;
+	  calls += out_degree[i];
+	  if (in_degree[i] == 0)
+	       roots++;
+	  if (out_degree[i] == 0)
+	       leaves++;
+	  c = call_graph.scc[i];
+	  if (graph_node_recursive(i)) {
+	       recursive++;
+	       scc_cyclic[c] = 1;
+	  }
+	  in_hist[bucket(in_degree[i])]++;
+	  out_hist[bucket(out_degree[i])]++;
+
+	  if (scc_count[c]++ == 0)
+	       components++;
+	  if (scc_count[c] > largest)
+	       largest = scc_count[c];
+
+	  /* Keep the top fan-in functions sorted by insertion */
+	  if (ntop < STATS_TOP || fan_in_before(i, top[ntop-1])) {
+	       if (ntop < STATS_TOP)
+		    ntop++;
+	       for (j = ntop - 1; j > 0 && fan_in_before(i, top[j-1]); j--)
+		    top[j] = top[j-1];
+	       top[j] = i;
+	  }
+
+	  symbols[num++] = sym;
+     }
+
+     for (i = 0; i < call_graph.nscc; i++)
+	  if (scc_count[i]) {
+	       scc_hist[bucket(scc_count[i])]++;
+	       if (scc_cyclic[i])
+		    cycles++;
+	  }
+
+     fprintf(outfile, "functions %lu\n", (unsigned long) functions);
+     fprintf(outfile, "undefined %lu\n", (unsigned long) undefined);
+     fprintf(outfile, "calls %lu\n", (unsigned long) calls);
+     fprintf(outfile, "roots %lu\n", (unsigned long) roots);
+     fprintf(outfile, "leaves %lu\n", (unsigned long) leaves);
+     fprintf(outfile, "recursive %lu\n", (unsigned long) recursive);
+     fprintf(outfile, "components %lu\n", (unsigned long) components);
+     fprintf(outfile, "cycles %lu\n", (unsigned long) cycles);
+     fprintf(outfile, "largest-component %lu\n", (unsigned long) largest);
+     print_histogram("in-degree", in_hist);
+     print_histogram("out-degree", out_hist);
+     print_histogram("component-size", scc_hist);
+     for (i = 0; i < ntop; i++)
+	  fprintf(outfile, "fan-in %s %lu\n", call_graph.sym[top[i]]->name,
+		  (unsigned long) in_degree[top[i]]);
+
+     qsort(symbols, num, sizeof(symbols[0]), compare_symbols);
+     for (i = 0; i < num; i++)
+	  fprintf(outfile, "degree %s %lu %lu\n", symbols[i]->name,
+		  (unsigned long) in_degree[symbols[i]->ord],
+		  (unsigned long) out_degree[symbols[i]->ord]);
+
+     free(in_degree);
+     free(out_degree);
+     free(scc_count);
+     free(scc_cyclic);
+     free(symbols);
+     in_degree = out_degree = NULL;
+}
@@ -17,6 +17,7 @@
 #include <cflow.h>
 #include <parser.h>
 #include <hash.h>
+#include <bitrotate.h>
 
 static Hash_table *symbol_table;
 
@@ -24,6 +25,8 @@ static struct linked_list *static_symbol_list;
 static struct linked_list *auto_symbol_list;
 static struct linked_list *static_func_list;
 static struct linked_list *unit_local_list;
+static Symbol *symbol_chain;   /* All allocated symbols, including the ones
+				  no longer in the table */
 
 static void
 append_symbol(struct linked_list **plist, Symbol *sp)
@@ -32,10 +35,8 @@ append_symbol(struct linked_list **plist, Symbol *sp)
 	  linked_list_unlink(sp->entry->list, sp->entry);
 	  sp->entry = NULL;
      }
-     if (!data_in_list(sp, *plist)) {
-	  linked_list_append(plist, sp);
-	  sp->entry = (*plist)->tail;
-     }
+     linked_list_append(plist, sp);
+     sp->entry = (*plist)->tail;
 }
 
 struct table_entry {
@@ -124,6 +125,10 @@ install(char *name, int flags)
 	  free(tp);
      }
      sym->owner = ret;
+     if (symbol_chain)
+	  symbol_chain->prev_alloc = sym;
+     sym->next_alloc = symbol_chain;
+     symbol_chain = sym;
      return sym;
 }
 
@@ -169,6 +174,72 @@ install_ident(char *name, enum storage storage)
      return sp;
 }
 
+/* Call graph edges.  Each caller/callee pair is registered in
+   edge_table, so that repeated calls are detected without scanning
+   the caller and callee lists.  The lists themselves keep the edges in
+   the order they were first seen. */
+
+struct edge {
+     Symbol *caller;
+     Symbol *callee;
+};
+
+static Hash_table *edge_table;
+
+static size_t
+hash_edge_hasher(void const *data, size_t n_buckets)
+{
+     struct edge const *e = data;
+     return (rotl_sz((size_t) e->caller, 7) ^ (size_t) e->callee) % n_buckets;
+}
+
+static bool
+hash_edge_compare(void const *data1, void const *data2)
+{
+     struct edge const *e1 = data1;
+     struct edge const *e2 = data2;
+     return e1->caller == e2->caller && e1->callee == e2->callee;
+}
+
+/* Record that CALLER refers to CALLEE, unless already done */
+void
+add_edge(Symbol *caller, Symbol *callee)
+{
+     struct edge key, *ep;
+
+     key.caller = caller;
+     key.callee = callee;
+     if (edge_table && hash_lookup(edge_table, &key))
+	  return;
+
+     ep = xmalloc(sizeof(*ep));
+     *ep = key;
+     if (! ((edge_table
+	     || (edge_table = hash_initialize(0, 0,
+					      hash_edge_hasher,
+					      hash_edge_compare, free)))
+	    && hash_insert(edge_table, ep)))
+	  xalloc_die();
+     
+     linked_list_append(&callee->caller, caller);
+     linked_list_append(&caller->callee, callee);
+}
+
+static void
+free_symbol(Symbol *sym)
+{
+     if (sym->prev_alloc)
+	  sym->prev_alloc->next_alloc = sym->next_alloc;
+     else
+	  symbol_chain = sym->next_alloc;
+     if (sym->next_alloc)
+	  sym->next_alloc->prev_alloc = sym->prev_alloc;
+     linked_list_destroy(&sym->ref_line);
+     linked_list_destroy(&sym->caller);
+     linked_list_destroy(&sym->callee);
+     free(sym);
+}
+
 /* Unlink the symbol from the table entry */
 static void
 unlink_symbol(Symbol *sym)
@@ -197,13 +268,11 @@ delete_symbol(Symbol *sym)
 {
      unlink_symbol(sym);
      /* The symbol could have been referenced even if it is static
-	in -i^s mode. See tests/static.at for details. */
-     if (sym->ref_line == NULL && !(reverse_tree && sym->callee)) {
-	  linked_list_destroy(&sym->ref_line);
-	  linked_list_destroy(&sym->caller);
-	  linked_list_destroy(&sym->callee);
-	  free(sym);
-     }
+	in -i^s mode. See tests/static.at for details.
+	A symbol that calls other symbols is kept as well: it appears
+	in their caller lists and in edge_table. */
+     if (sym->ref_line == NULL && sym->callee == NULL)
+	  free_symbol(sym);
 }     
 
 /* Delete from the symbol table all static symbols defined in the current
@@ -221,6 +290,7 @@ static_free(void *data)
      Symbol *sym = data;
      struct table_entry *t = sym->owner;
 
+     sym->entry = NULL;
      if (!t)
 	  return;
      if (sym->flag == symbol_local) {
@@ -259,6 +329,7 @@ delete_level_autos(void *data, void *call_data)
      int level = *(int*)call_data;
      Symbol *s = data;
      if (s->level == level) {
+	  s->entry = NULL;
 	  delete_symbol(s);
 	  return 1;
      }
@@ -271,6 +342,7 @@ delete_level_statics(void *data, void *call_data)
      int level = *(int*)call_data;
      Symbol *s = data;
      if (s->level == level) {
+	  s->entry = NULL;
 	  unlink_symbol(s);
 	  return 1;
      }
@@ -284,6 +356,36 @@ delete_autos(int level)
      linked_list_iterate(&static_symbol_list, delete_level_statics, &level);
 }
 
+static bool
+free_entry(void *data, void *proc_data)
+{
+     free(data);
+     return true;
+}
+
+/* Free all symbols, including the ones deleted from the table but still
+   referred to from the call graph, and return the symbol table to its
+   initial empty state. */
+void
+delete_all_symbols()
+{
+     linked_list_destroy(&static_symbol_list);
+     linked_list_destroy(&auto_symbol_list);
+     linked_list_destroy(&static_func_list);
+     linked_list_destroy(&unit_local_list);
+     if (symbol_table) {
+	  hash_do_for_each(symbol_table, free_entry, NULL);
+	  hash_free(symbol_table);
+	  symbol_table = NULL;
+     }
+     if (edge_table) {
+	  hash_free(edge_table);
+	  edge_table = NULL;
+     }
+     while (symbol_chain)
+	  free_symbol(symbol_chain);
+}
+
 struct collect_data {
      Symbol **sym;
      int (*sel)(Symbol *p);
@@ -373,10 +475,13 @@ delete_parms_itr(void *data, void *call_data)
      Symbol *s = data;
      struct table_entry *t = s->owner;
 	  
-     if (!t)
+     if (!t) {
+	  s->entry = NULL;
 	  return 1;
+     }
      if (s->type == SymIdentifier && s->storage == AutoStorage
 	 && s->flag == symbol_parm && s->level > level) {
+	  s->entry = NULL;
 	  delete_symbol(s);
 	  return 1;
      }